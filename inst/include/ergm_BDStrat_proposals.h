@@ -77,10 +77,47 @@ typedef struct {
   // matrix storing indices of included strat mixing types
   int **indmat;
 
+  // indices of the included strat mixing types in each row and column
+  // of indmat, in compressed form: those in row i (column j) are
+  // strat_rowtypes[strat_rowstart[i]..strat_rowstart[i + 1] - 1]
+  // (strat_coltypes[strat_colstart[j]..strat_colstart[j + 1] - 1])
+  int *strat_rowstart;
+  int *strat_rowtypes;
+  int *strat_colstart;
+  int *strat_coltypes;
+
   // flag: are we running the contrastive divergence algorithm?
   int CD;
 } BDStratTNTStorage;
 
+// helper function to record whether the strat mixing type infl_i will have
+// a change in toggleability status if we accept the proposed toggle; must be
+// called with the node lists set to their proposed state
+static inline void CheckChangeToToggleability(int infl_i, BDStratTNTStorage *sto) {
+  // if this strat type is the same as the strat type of the proposed
+  // toggle, then it cannot change toggleability status, so skip it
+  if(infl_i == sto->stratmixingtype) {
+    return;
+  }
+
+  // can we toggle this mixing type in the current network?
+  int toggle_curr = WtPopGetWt(infl_i, sto->wtp) > 0;
+
+  // will we be able to toggle this mixing type in the proposed network? 
+  int toggle_prop = sto->hash[infl_i]->list->nedges > 0
+                    || BDStratBlocksDyadCountPositive(sto->blocks, infl_i);
+
+  // will there be a change in toggleability status?
+  int change = toggle_prop - toggle_curr;
+
+  // if so, take this into account
+  if(change) {
+    sto->proposed_total_weight += change*sto->original_weights[infl_i];
+    sto->strat_mixtypestoupdate[sto->strat_nmixtypestoupdate] = infl_i;
+    sto->strat_nmixtypestoupdate++;
+  }
+}
+
 // helper function to determine which strat mixing types (if any) will
 // have a change in toggleability status if we accept the proposed toggle
 static inline void ComputeChangesToToggleability(Vertex *tail, Vertex *head, BDStratTNTStorage *sto) {
@@ -99,41 +136,19 @@ static inline void ComputeChangesToToggleability(Vertex *tail, Vertex *head, BDS
     // would be in the proposed network
     BDNodeListsToggleIf(*tail, *head, sto->lists, sto->tailmaxl, sto->headmaxl);
 
-    // how many strat types do we need to check?
+    // only the included strat types in the tail's row and the head's
+    // column of the indmat can be affected; in the undirected case,
+    // these coincide if tail and head have the same strat attribute
     int tailattr = sto->strat_vattr[*tail];
     int headattr = sto->strat_vattr[*head];
-    int ntocheck = ((!sto->lists->directed) && (tailattr == headattr)) 
-                   ? sto->strat_nlevels : 2*sto->strat_nlevels;
-
-    for(int i = 0; i < ntocheck; i++) {
-      // find the index of the i'th strat type we need to check,
-      // by looking it up in the indmat
-      int row = i < sto->strat_nlevels ? tailattr : i - sto->strat_nlevels;
-      int col = i < sto->strat_nlevels ? i : headattr;
-      int infl_i = sto->indmat[row][col];
-
-      // if this strat type is not included in the proposal, or is the same as
-      // the strat type of the proposed toggle, then it cannot change
-      // toggleability status, so skip it
-      if(infl_i < 0 || infl_i == sto->stratmixingtype) {
-        continue;
-      }
 
-      // can we toggle this mixing type in the current network?
-      int toggle_curr = WtPopGetWt(infl_i, sto->wtp) > 0;
-
-      // will we be able to toggle this mixing type in the proposed network? 
-      int toggle_prop = sto->hash[infl_i]->list->nedges > 0
-                        || BDStratBlocksDyadCountPositive(sto->blocks, infl_i);
-
-      // will there be a change in toggleability status?
-      int change = toggle_prop - toggle_curr;
+    for(int i = sto->strat_rowstart[tailattr]; i < sto->strat_rowstart[tailattr + 1]; i++) {
+      CheckChangeToToggleability(sto->strat_rowtypes[i], sto);
+    }
 
-      // if so, take this into account
-      if(change) {
-        sto->proposed_total_weight += change*sto->original_weights[infl_i];
-        sto->strat_mixtypestoupdate[sto->strat_nmixtypestoupdate] = infl_i;
-        sto->strat_nmixtypestoupdate++;
+    if(sto->lists->directed || tailattr != headattr) {
+      for(int i = sto->strat_colstart[headattr]; i < sto->strat_colstart[headattr + 1]; i++) {
+        CheckChangeToToggleability(sto->strat_coltypes[i], sto);
       }
     }
 
@@ -12,6 +12,7 @@
 
 #include "ergm_edgetree.h"
 #include "R_ext/Rdynload.h"
+#include "ergm_rng.h"
 
 #define NO_EDGE       0x00 /*these four used in realocateWithReplacement */
 #define OLD_EDGE      0x01 
@@ -71,6 +72,11 @@ typedef struct MHProposalstruct {
   void **aux_storage;
   unsigned int n_aux;
   unsigned int *aux_slots;
+  ErgmRNG *rng; /* source of uniforms for the proposal; see ergm_rng.h */
+  Rboolean edge_index; /* if TRUE, proposals that draw random edges should call NetworkEdgeIndexEnable(); see ergm_edgetree.h */
+  Rboolean compact; /* if TRUE, the MCMC sampler periodically rebuilds the edgetrees of the network; see NetworkCompact() */
+  Rboolean gibbs; /* if TRUE, the MCMC sampler may treat the proposed toggles as a block of distinct dyads and draw its configuration from its full conditional distribution instead */
+  Vertex nodeswap[2]; /* if nonzero, the proposed toggles exchange the labels of these two vertices; see ergm_nodeswap.h */
 } MHProposal;
 
 
@@ -83,6 +89,9 @@ void MHProposalDestroy(MHProposal *MHp, Network *nwp);
 #define MH_INPUTS MH_DINPUTS
 #define MH_IINPUTS MHp->iinputs
 
+/* A Uniform(0,1) draw from the proposal's generator. */
+#define MH_UNIF_RAND() ErgmRNGUnif(MHp->rng)
+
 #define Mtail (MHp->toggletail)
 #define Mhead (MHp->togglehead)
 
@@ -21,6 +21,14 @@ typedef struct DegreeBoundstruct {
   int *minout;
   int *maxin;
   int *minin;
+  /* outattr[v-1 + k*nnodes] is the number of out-neighbors (neighbors,
+     if undirected) of v with attribs[, k] set, and inattr likewise for
+     in-neighbors (the same array, if undirected); they are kept current
+     via a network callback, so that checking a toggle does not require
+     making it or walking the endpoints' edges. */
+  int *outattr;
+  int *inattr;
+  Network *nwp;
 } DegreeBound;
 
 DegreeBound* DegreeBoundInitializeR(SEXP MHpR, Network *nwp);
@@ -162,6 +162,35 @@ typedef struct ModelTermstruct {
 #define X_CHANGESTAT_FN(a) void a (unsigned int type, void *data, ModelTerm *mtp, Network *nwp)
 #define Z_CHANGESTAT_FN(a) void a (ModelTerm *mtp, Network *nwp, Rboolean skip_s)
 
+/* Declare a change statistic a whose body is compiled, in addition to
+   the generic version, into four variants specialized to whether the
+   network is directed (D or U) and whether the term has double
+   inputs (A or N), named a__DA, a__DN, a__UA, and a__UN. In each
+   variant, DIRECTED (and therefore EXEC_THROUGH_OUTEDGES, etc.) and
+   the test N_INPUT_PARAMS==0 are compile-time constants, and
+   ModelInitialize() will use the variant that matches the term in
+   place of the generic version if it finds it. It is used in place
+   of C_CHANGESTAT_FN, e.g.,
+
+   C_CHANGESTAT_FN_SPECIALIZED(c_transitiveties) { ... }
+*/
+#ifdef __GNUC__
+#define _ERGM_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define _ERGM_ALWAYS_INLINE
+#endif
+
+#define _C_CHANGESTAT_FN_SPEC_BODY(a) static inline _ERGM_ALWAYS_INLINE void a ## _spec (Vertex tail, Vertex head, ModelTerm *mtp, Network *nwp, Rboolean edgestate, const int _ergm_spec_directed, const int _ergm_spec_inputs)
+
+#define C_CHANGESTAT_FN_SPECIALIZED(a)                                  \
+  _C_CHANGESTAT_FN_SPEC_BODY(a);                                        \
+  C_CHANGESTAT_FN(a){ a ## _spec(tail, head, mtp, nwp, edgestate, -1, -1); } \
+  C_CHANGESTAT_FN(a ## __DA){ a ## _spec(tail, head, mtp, nwp, edgestate, 1, 1); } \
+  C_CHANGESTAT_FN(a ## __DN){ a ## _spec(tail, head, mtp, nwp, edgestate, 1, 0); } \
+  C_CHANGESTAT_FN(a ## __UA){ a ## _spec(tail, head, mtp, nwp, edgestate, 0, 1); } \
+  C_CHANGESTAT_FN(a ## __UN){ a ## _spec(tail, head, mtp, nwp, edgestate, 0, 0); } \
+  _C_CHANGESTAT_FN_SPEC_BODY(a)
+
 /* This macro wraps two calls to an s_??? function with toggles
    between them. */
 #define D_FROM_S							\
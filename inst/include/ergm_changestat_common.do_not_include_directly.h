@@ -32,7 +32,7 @@ double my_choose(double n, int r);
 #define N_DYADS (DYADCOUNT(nwp))
 #define OUT_DEG (nwp->outdegree) /* Vector of length N_NODES giving current outdegrees */
 #define IN_DEG (nwp->indegree) /* Vector of length N_NODES giving current indegrees */
-#define DIRECTED (nwp->directed_flag) /* 0 if network is undirected, 1 if directed */
+#define DIRECTED (_ergm_spec_directed >= 0 ? _ergm_spec_directed : nwp->directed_flag) /* 0 if network is undirected, 1 if directed */
 #define N_EDGES (EDGECOUNT(nwp)) /* Total number of edges in the network currently */
 
 /* 0 if network is not bipartite, otherwise number of nodes of the first type (the first node of the second type has Vertex index BIPARTITE+1 */
@@ -52,11 +52,21 @@ double my_choose(double n, int r);
 /* Number of change statistics required by the current term */
 #define N_CHANGE_STATS (mtp->nstats)
 
+/* In the body of a change statistic declared with
+   C_CHANGESTAT_FN_SPECIALIZED, these are shadowed by compile-time
+   constants (0 or 1) giving whether the network is directed and
+   whether the term has double inputs; elsewhere, they are -1, and
+   DIRECTED and N_INPUT_PARAMS are looked up at runtime. */
+#ifndef _ERGM_SPEC_CONSTANTS_
+#define _ERGM_SPEC_CONSTANTS_
+static const int _ergm_spec_directed = -1, _ergm_spec_inputs = -1;
+#endif // _ERGM_SPEC_CONSTANTS_
+
 /* Vector of values passed via "inputs" from R */
 #define INPUT_PARAM DINPUT_PARAM
 #define N_INPUT_PARAMS N_DINPUT_PARAMS /* Number of inputs passed */
 #define DINPUT_PARAM (mtp->inputparams)
-#define N_DINPUT_PARAMS (mtp->ninputparams) /* Number of inputs passed */
+#define N_DINPUT_PARAMS (_ergm_spec_inputs == 0 ? 0 : mtp->ninputparams) /* Number of inputs passed */
 #define IINPUT_PARAM (mtp->iinputparams)
 #define N_IINPUT_PARAMS (mtp->niinputparams) /* Number of inputs passed */
 
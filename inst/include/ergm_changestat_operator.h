@@ -48,6 +48,25 @@
     addonto((output), (m)->workspace, (m)->n_stats);                    \
   }
 
+/* Like PROPAGATE_X_SIGNAL_INTO() the model's workspace, but if the
+   model's signals are memoized (see ModelXMemoEnable()), only the
+   first of its users to propagate a given signal sends it to the
+   model's terms. */
+#define PROPAGATE_X_SIGNAL_SHARED(onwp, m)                              \
+  {                                                                     \
+    if(!(m)->xmemo) PROPAGATE_X_SIGNAL_INTO((onwp), (m), (m)->workspace) \
+    else{                                                               \
+      if(!(m)->xmemo_left || (m)->xmemo_type != (type) || (m)->xmemo_data != (data)){ \
+        PROPAGATE_X_SIGNAL_INTO((onwp), (m), (m)->xmemo);               \
+        (m)->xmemo_type = (type);                                       \
+        (m)->xmemo_data = (data);                                       \
+        (m)->xmemo_left = (m)->xmemo_users;                             \
+      }                                                                 \
+      (m)->xmemo_left--;                                                \
+      memcpy((m)->workspace, (m)->xmemo, (m)->n_stats*sizeof(double));  \
+    }                                                                   \
+  }
+
 #define X_CHANGESTAT_PROPAGATE_FN(a, getstorage, getm)                  \
   X_CHANGESTAT_FN(a) {                                                  \
     getstorage;                                                         \
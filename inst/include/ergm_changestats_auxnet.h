@@ -23,15 +23,15 @@ MAP_TOGGLE_FN(map_toggle__discord_net_Network){
 #define map_toggle_maxtoggles__intersect_net_Network 1
 MAP_TOGGLE_FN(map_toggle__intersect_net_Network){
   ModelTerm *mtp = auxnet->mtp;
-  int *ref_el = IINPUT_PARAM;
-  MAP_TOGGLE_PROPAGATE_IF(iEdgeListSearch(tail, head, ref_el));
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
+  MAP_TOGGLE_PROPAGATE_IF(EdgeListIndexSearch(tail, head, idx));
 }
 
 #define map_toggle_maxtoggles__union_net_Network 1
 MAP_TOGGLE_FN(map_toggle__union_net_Network){
   ModelTerm *mtp = auxnet->mtp;
-  int *ref_el = IINPUT_PARAM;
-  MAP_TOGGLE_PROPAGATE_IF(!iEdgeListSearch(tail, head, ref_el));
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
+  MAP_TOGGLE_PROPAGATE_IF(!EdgeListIndexSearch(tail, head, idx));
 }
 
 #define map_toggle_maxtoggles__blockdiag_net 1
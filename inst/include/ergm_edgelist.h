@@ -83,4 +83,79 @@ static inline unsigned int iEdgeListSearch(Vertex tail, Vertex head, int *el){
   if((u==l) && tail==tails[l] && head==heads[l]) return(l); else return(0);
 }
 
+/*********************
+ EdgeListIndex
+
+ A static index of an edgelist of int as documented above, for
+ checking many dyads against a large edgelist: a filter with two bits
+ per edge, set at hashed positions in a bit array of at least 8 bits
+ per edge, rejects most dyads not in the list (all but about 5%)
+ without touching the list, and the rest are looked up by a binary
+ search confined to the edges with the same tail.
+*********************/
+
+typedef struct {
+  int *el;
+  Vertex maxtail;
+  unsigned int *tailstart; // Position in el of the first edge of each tail.
+  uint64_t *bits;
+  unsigned int shift; // 64 - log2(number of bits)
+} EdgeListIndex;
+
+#define EDGELISTINDEX_HASH(tail, head) (((uint64_t)(tail) * 0x9E3779B97F4A7C15ull ^ (uint64_t)(head)) * 0xBF58476D1CE4E5B9ull)
+#define EDGELISTINDEX_BIT1(idx, h) ((h) >> (idx)->shift)
+#define EDGELISTINDEX_BIT2(idx, h) (((h) << 32 | (h) >> 32) >> (idx)->shift)
+#define EDGELISTINDEX_TEST(idx, b) ((idx)->bits[(b) >> 6] >> ((b) & 63) & 1)
+#define EDGELISTINDEX_SET(idx, b) ((idx)->bits[(b) >> 6] |= (uint64_t)1 << ((b) & 63))
+
+static inline void EdgeListIndexInitialize(EdgeListIndex *idx, int *el){
+  Edge nedges = el[0];
+  int *tails = el, *heads = el + nedges;
+  idx->el = el;
+
+  idx->maxtail = nedges ? tails[nedges] : 0;
+  idx->tailstart = Calloc(idx->maxtail + 2, unsigned int);
+  for(Edge i = nedges; i >= 1; i--) idx->tailstart[tails[i]] = i;
+  idx->tailstart[idx->maxtail + 1] = nedges + 1;
+  // Tails without edges start where the next tail does.
+  for(Vertex t = idx->maxtail; t >= 1; t--)
+    if(!idx->tailstart[t]) idx->tailstart[t] = idx->tailstart[t+1];
+
+  // At least 8 bits per edge, rounded up to a power of 2; computed in
+  // 64 bits, since it can exceed the range of Edge.
+  uint64_t minbits = (uint64_t)8 * nedges;
+  unsigned int lg = 6;
+  while(((uint64_t)1 << lg) < minbits) lg++;
+  idx->shift = 64 - lg;
+  idx->bits = Calloc((size_t)(((uint64_t)1 << lg) / 64), uint64_t);
+  for(Edge i = 1; i <= nedges; i++){
+    uint64_t h = EDGELISTINDEX_HASH(tails[i], heads[i]);
+    EDGELISTINDEX_SET(idx, EDGELISTINDEX_BIT1(idx, h));
+    EDGELISTINDEX_SET(idx, EDGELISTINDEX_BIT2(idx, h));
+  }
+}
+
+static inline void EdgeListIndexDestroy(EdgeListIndex *idx){
+  Free(idx->tailstart);
+  Free(idx->bits);
+}
+
+/* Returns the index of the edge (counting from 1) if found, 0 if
+   not, as iEdgeListSearch() does. */
+static inline unsigned int EdgeListIndexSearch(Vertex tail, Vertex head, EdgeListIndex *idx){
+  uint64_t h = EDGELISTINDEX_HASH(tail, head);
+  if(!EDGELISTINDEX_TEST(idx, EDGELISTINDEX_BIT1(idx, h)) ||
+     !EDGELISTINDEX_TEST(idx, EDGELISTINDEX_BIT2(idx, h)) ||
+     tail > idx->maxtail) return 0;
+
+  unsigned int l = idx->tailstart[tail], u = idx->tailstart[tail+1];
+  int *heads = idx->el + idx->el[0];
+  while(l < u){
+    unsigned int m = l + (u-l)/2;
+    if(head > heads[m]) l = m+1;
+    else u = m;
+  }
+  return l < idx->tailstart[tail+1] && heads[l] == head ? l : 0;
+}
+
 #endif
@@ -11,6 +11,7 @@
 #define _ERGM_EDGETREE_H_
 
 #include "ergm_edgetree_common.do_not_include_directly.h"
+#include "ergm_unsorted_edgelist.h"
 
 /*  TreeNode is a binary tree structure, which is how the edgelists 
     are stored.  The root of the tree for vertex i will be inedges[i]
@@ -28,6 +29,24 @@ typedef struct TreeNodestruct {
   Edge right;    /*  right child (0 if none) */
 } TreeNode;
 
+/* NetworkEdgeIndex is an optional index of the edges of a network,
+   maintained alongside the edgetrees once enabled.
+
+   el holds the edges in no particular order, so that a random edge
+   can be selected in constant time regardless of how fragmented the
+   outedges array is.  pos[e] is the position in el of the edge whose
+   head is stored in outedges[e] (and 0 for slots not in use); it is
+   kept up to date as the nodes of the outedges array are moved
+   around.  fenwick is a Fenwick (binary indexed) tree over
+   outdegree[], so that the tail of the ith edge or nonedge can be
+   found in O(log n) time.
+*/
+typedef struct NetworkEdgeIndexstruct {
+  UnsrtEL *el;
+  Edge *pos;
+  Edge *fenwick;
+} NetworkEdgeIndex;
+
 /* Network is a structure containing all essential elements
    of a given network; it is a slightly rewritten version of the old Gptr,
    with some changes of awkard things, deletion of unnecessary things, and
@@ -44,6 +63,8 @@ typedef struct TreeNodestruct {
      the appropriate degree values for each vertex.  These should
      point to Vertex-vectors of length nnodes+1.  
    value:  optional value(s) associated with this network 
+   eindex: an optional NetworkEdgeIndex (see above), NULL unless it
+     has been enabled by NetworkEdgeIndexEnable()
 */
 typedef struct Networkstruct {
   TreeNode *inedges;
@@ -63,6 +84,8 @@ typedef struct Networkstruct {
   unsigned int max_on_edge_change;
   void (**on_edge_change)(Vertex, Vertex, void*, struct Networkstruct*, Rboolean);
   void **on_edge_change_payload;
+
+  NetworkEdgeIndex *eindex;
 } Network;
 typedef void (*OnNetworkEdgeChange)(Vertex, Vertex, void*, Network*, Rboolean);
 
@@ -81,6 +104,10 @@ Network *NetworkInitializeD(double *tails, double *heads, Edge nedges,
 
 Network *NetworkCopy(Network *src);
 
+void NetworkEdgeIndexEnable(Network *nwp);
+void NetworkCompact(Network *nwp);
+void NetworkGetEdgetreeStats(Network *nwp, EdgetreeStats *stats);
+
 SEXP Network2Redgelist(Network *nwp);
 Network *Redgelist2Network(SEXP elR, Rboolean empty);
 
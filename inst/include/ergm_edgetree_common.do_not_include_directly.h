@@ -38,13 +38,15 @@
   }
 
 // This one is implemented as a macro, since it's very simple and works exactly the same for weighted and unweighted.
-#define GetRandDyad(tail, head, nwp)					\
+// GetRandDyadUnif() takes the expression to evaluate for each Uniform(0,1) draw.
+#define GetRandDyad(tail, head, nwp) GetRandDyadUnif(tail, head, nwp, unif_rand())
+#define GetRandDyadUnif(tail, head, nwp, unif)				\
   if((nwp)->bipartite){							\
-    *(tail) = 1 + unif_rand() * (nwp)->bipartite;			\
-    *(head) = 1 + (nwp)->bipartite + unif_rand() * ((nwp)->nnodes - (nwp)->bipartite); \
+    *(tail) = 1 + (unif) * (nwp)->bipartite;				\
+    *(head) = 1 + (nwp)->bipartite + (unif) * ((nwp)->nnodes - (nwp)->bipartite); \
   }else{								\
-    *(tail) = 1 + unif_rand() * (nwp)->nnodes;				\
-    *(head) = 1 + unif_rand() * ((nwp)->nnodes-1);			\
+    *(tail) = 1 + (unif) * (nwp)->nnodes;				\
+    *(head) = 1 + (unif) * ((nwp)->nnodes-1);				\
     if(*(head)>=*(tail)) (*(head))++;					\
     									\
     if (!(nwp)->directed_flag && *(tail) > *(head)) {			\
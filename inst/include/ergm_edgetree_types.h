@@ -15,4 +15,20 @@ typedef unsigned int Vertex;
 typedef unsigned int Edge;
 typedef uint_least64_t Dyad;
 
+/* Layout of the outedges array of a (Wt)Network, as reported by
+   (Wt)NetworkGetEdgetreeStats():
+   span: the highest index in use (last_outedge);
+   capacity: the number of TreeNodes allocated (maxedges);
+   empty: the fraction of TreeNodes 1..span not holding an edge, which
+     is the rejection rate of GetRandEdge() without an index;
+   depth: the mean depth of the edges in their trees (0 for a root),
+     and mindepth the same if all trees were perfectly balanced;
+   contiguous: the fraction of vertices with two or more edges whose
+     non-root TreeNodes occupy a contiguous block of the array.
+*/
+typedef struct EdgetreeStatsstruct {
+  Edge span, capacity;
+  double empty, depth, mindepth, contiguous;
+} EdgetreeStats;
+
 #endif // _ERGM_EDGETREE_TYPES_H_
@@ -34,6 +34,12 @@ typedef struct Modelstruct {
 			  termarray[i].nstats                    */
   unsigned int n_aux;
   Rboolean noinit_s;
+  double *memo; /* if not NULL, change statistics for the toggle of (memo_tail, memo_head) */
+  Vertex memo_tail, memo_head;
+  double *xmemo; /* if not NULL, change statistics for the signal (xmemo_type, xmemo_data) */
+  unsigned int xmemo_type;
+  void *xmemo_data;
+  unsigned int xmemo_users, xmemo_left; /* number of terms propagating signals into the model and of those yet to propagate the memoized one */
 } Model;
 
 #define FOR_EACH_TERM(m) for(ModelTerm *mtp = (m)->termarray; mtp < (m)->termarray + (m)->n_terms; mtp++)
@@ -108,5 +114,41 @@ void ChangeStats1(Vertex tail, Vertex head, Network *nwp, Model *m, Rboolean edg
 void ZStats(Network *nwp, Model *m, Rboolean skip_s);
 void EmptyNetworkStats(Model *m, Rboolean skip_s);
 void SummStats(Edge n_edges, Vertex *tails, Vertex *heads, Network *nwp, Model *m);
+
+/* Let ChangeStats1() reuse the change statistics it had computed for
+   the same toggle, for models evaluated by several terms. Whoever
+   enables it must call ModelMemoReset() whenever the network
+   changes, e.g., from a u_function. */
+static inline void ModelMemoEnable(Model *m){
+  if(!m->memo) m->memo = Calloc(m->n_stats, double);
+  m->memo_tail = m->memo_head = 0;
+}
+
+static inline void ModelMemoReset(Model *m){
+  m->memo_tail = 0;
+}
+
+/* Let a signal propagated into the model by several terms reach its
+   terms only once: the first of the model's users to propagate it
+   computes the change statistics, and the others reuse them until
+   each has had them or a different signal arrives. The term that
+   enables it counts as the first user; every other term propagating
+   signals into the model must call ModelXMemoUse() when it is
+   initialized, and all of them must propagate signals through
+   PROPAGATE_X_SIGNAL_SHARED(). As with ModelMemoEnable(),
+   ModelXMemoReset() must be called whenever the network changes. */
+static inline void ModelXMemoEnable(Model *m){
+  if(!m->xmemo) m->xmemo = Calloc(m->n_stats, double);
+  m->xmemo_users = 1;
+  m->xmemo_left = 0;
+}
+
+static inline void ModelXMemoUse(Model *m){
+  if(m->xmemo) m->xmemo_users++;
+}
+
+static inline void ModelXMemoReset(Model *m){
+  m->xmemo_left = 0;
+}
 #endif
 
@@ -0,0 +1,74 @@
+/*  File inst/include/ergm_nodeswap.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _ERGM_NODESWAP_H_
+#define _ERGM_NODESWAP_H_
+
+#include "ergm_edgetree.h"
+#include "ergm_changestat.h"
+
+/* A proposal that sets MHp->nodeswap to a pair of distinct vertices
+   (in the same bipartite mode) proposes the network obtained by
+   exchanging their labels: every edge (t,h) becomes (pi(t),pi(h)),
+   where pi swaps the two vertices. It must still list the toggles
+   that this entails, since they are used to commit the move and to
+   evaluate the terms that cannot do better.
+
+   Before falling back to the toggles, the sampler sends each term
+   with statistics an ERGM_NODESWAP_SIGNAL x_function signal, with
+   an ErgmNodeSwap as its data and mtp->dstats zeroed. A term that
+   can compute the change in its statistics due to the relabeling
+   directly should write it to CHANGE_STAT and set handled to
+   TRUE. Since operator terms pass signals on to their submodels, a
+   term must ignore the signal unless it is addressed to it; the
+   GET_NODESWAP() macro below takes care of that. */
+
+#define ERGM_NODESWAP_SIGNAL 0x4e53574bu /* "NSWK" */
+
+typedef struct ErgmNodeSwapstruct {
+  Vertex v1, v2;
+  ModelTerm *mtp; /* the term being asked */
+  Rboolean handled;
+} ErgmNodeSwap;
+
+/* Inside an X_CHANGESTAT_FN, return unless the signal is a node swap
+   addressed to this term; otherwise, declare ns pointing to it. */
+#define GET_NODESWAP(ns)                                                \
+  if(type != ERGM_NODESWAP_SIGNAL || ((ErgmNodeSwap *) data)->mtp != mtp) return; \
+  ErgmNodeSwap *ns = data;
+
+/* Compute the change due to the node swap of a dyad-independent term
+   whose c_function adds (rather than assigns) its change to
+   CHANGE_STAT. Only the edges incident on the two vertices are
+   affected: each is removed and its relabeled counterpart added. */
+static inline void NodeSwapDyadIndependent(ErgmNodeSwap *ns, ModelTerm *mtp, Network *nwp){
+  Vertex v1 = ns->v1, v2 = ns->v2;
+
+#define NODESWAP_PI(v) ((v) == v1 ? v2 : (v) == v2 ? v1 : (v))
+#define NODESWAP_EDGE(t, h) {                                           \
+    mtp->c_func((t), (h), mtp, nwp, TRUE);                              \
+    Vertex _pt = NODESWAP_PI(t);                                        \
+    Vertex _ph = NODESWAP_PI(h);                                        \
+    if(!DIRECTED && _pt > _ph){ Vertex _tmp = _pt; _pt = _ph; _ph = _tmp; } \
+    mtp->c_func(_pt, _ph, mtp, nwp, FALSE);                             \
+  }
+
+  EXEC_THROUGH_FOUTEDGES(v1, e, u, NODESWAP_EDGE(v1, u));
+  EXEC_THROUGH_FINEDGES(v1, e, u, NODESWAP_EDGE(u, v1));
+  // Edges between v1 and v2 have already been counted.
+  EXEC_THROUGH_FOUTEDGES(v2, e, u, if(u != v1) NODESWAP_EDGE(v2, u));
+  EXEC_THROUGH_FINEDGES(v2, e, u, if(u != v1) NODESWAP_EDGE(u, v2));
+
+#undef NODESWAP_EDGE
+#undef NODESWAP_PI
+
+  ns->handled = TRUE;
+}
+
+#endif // _ERGM_NODESWAP_H_
@@ -12,6 +12,7 @@
 
 #include <limits.h>
 #include "ergm_edgetree.h"
+#include "ergm_rng.h"
 
 /* Serialization format for RLE-encoded Binary Dyad Matrix with only
    TRUE (1) values stored, with indices and lengths stored as Double
@@ -144,15 +145,18 @@ Generate a random dyad that belongs to a run using rejection sampling
 due to multiple unif_rand() calls. However, because runs tend to have
 similar lengths, the acceptance probability is likely to be high.
 
+@note GetRandRLEBDM1D_RS_RNG() draws the uniforms from rng (see
+ergm_rng.h) rather than from R's generator.
+
 */
-static inline void GetRandRLEBDM1D_RS(Vertex *tail, Vertex *head, const RLEBDM1D *m){
+static inline void GetRandRLEBDM1D_RS_RNG(Vertex *tail, Vertex *head, const RLEBDM1D *m, ErgmRNG *rng){
   RLERun r;
   double l;
   double u;
   double pr;
   do{
     // Select a run at random
-    u = unif_rand(); // ~Uniform(0,1)
+    u = ErgmRNGUnif(rng); // ~Uniform(0,1)
     double x = u * m->nruns + 1; // ~Uniform(1, m->nruns+1)
     r = floor(x); // ~DUniform(1..m->nruns)
     u = x - r; // ~Uniform(0,1)
@@ -167,11 +171,15 @@ static inline void GetRandRLEBDM1D_RS(Vertex *tail, Vertex *head, const RLEBDM1D
   // length, and l is its length.
 
   // Dyad ID
-  Dyad d = (Dyad)m->starts[r-1] + (l==1 ? 0 : unif_rand()*l);
+  Dyad d = (Dyad)m->starts[r-1] + (l==1 ? 0 : ErgmRNGUnif(rng)*l);
 
   Dyad2TH(tail, head, d, m->n);
 }
 
+static inline void GetRandRLEBDM1D_RS(Vertex *tail, Vertex *head, const RLEBDM1D *m){
+  GetRandRLEBDM1D_RS_RNG(tail, head, m, NULL);
+}
+
 /**
 Test if a dyad is present in a run
 
@@ -0,0 +1,50 @@
+/*  File inst/include/ergm_rng.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _ERGM_RNG_H_
+#define _ERGM_RNG_H_
+
+#include <stdint.h>
+#include <R.h>
+#include <Rmath.h>
+
+/* A buffered source of uniform random numbers for the proposals.
+
+   In the ERGM_RNG_R mode, ErgmRNGUnif() simply calls unif_rand(), so
+   the stream is bitwise identical to R's. In the ERGM_RNG_FAST mode,
+   the uniforms are generated ERGM_RNG_BUFSIZE at a time by a
+   xoshiro256+ generator seeded from R's generator when it is created,
+   so the results are still reproducible with set.seed() but do not
+   match the R stream.
+
+   A NULL pointer is treated as an ERGM_RNG_R generator. */
+typedef enum {ERGM_RNG_R = 0, ERGM_RNG_FAST = 1} ErgmRNGMode;
+
+#define ERGM_RNG_BUFSIZE 256
+
+typedef struct ErgmRNGstruct {
+  ErgmRNGMode mode;
+  unsigned int pos;
+  uint64_t s[4];
+  double buf[ERGM_RNG_BUFSIZE];
+} ErgmRNG;
+
+ErgmRNG *ErgmRNGInitialize(ErgmRNGMode mode);
+void ErgmRNGDestroy(ErgmRNG *rng);
+void ErgmRNGFill(ErgmRNG *rng);
+
+/* A Uniform(0,1) draw; as with unif_rand(), 0 and 1 are never
+   returned. */
+static inline double ErgmRNGUnif(ErgmRNG *rng){
+  if(!rng || rng->mode == ERGM_RNG_R) return unif_rand();
+  if(rng->pos == ERGM_RNG_BUFSIZE) ErgmRNGFill(rng);
+  return rng->buf[rng->pos++];
+}
+
+#endif // _ERGM_RNG_H_
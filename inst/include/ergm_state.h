@@ -23,6 +23,7 @@ typedef struct{
   Model *m;
   MHProposal *MHp;
   SEXP save;
+  unsigned int mh_unsuccessful; /* unsuccessful proposals in a parallel region, to be warned about by the caller */
 } ErgmState;
 
 ErgmState *ErgmStateInit(// Network settings
@@ -127,6 +127,21 @@ static Network * (*fun)(Network *) = NULL;
 if(fun==NULL) fun = (Network * (*)(Network *)) R_FindSymbol("NetworkCopy", "ergm", NULL);
 return fun(src);
 }
+void NetworkEdgeIndexEnable(Network *nwp){
+static void (*fun)(Network *) = NULL;
+if(fun==NULL) fun = (void (*)(Network *)) R_FindSymbol("NetworkEdgeIndexEnable", "ergm", NULL);
+fun(nwp);
+}
+void NetworkCompact(Network *nwp){
+static void (*fun)(Network *) = NULL;
+if(fun==NULL) fun = (void (*)(Network *)) R_FindSymbol("NetworkCompact", "ergm", NULL);
+fun(nwp);
+}
+void NetworkGetEdgetreeStats(Network *nwp, EdgetreeStats *stats){
+static void (*fun)(Network *,EdgetreeStats *) = NULL;
+if(fun==NULL) fun = (void (*)(Network *,EdgetreeStats *)) R_FindSymbol("NetworkGetEdgetreeStats", "ergm", NULL);
+fun(nwp,stats);
+}
 SEXP Network2Redgelist(Network *nwp){
 static SEXP (*fun)(Network *) = NULL;
 if(fun==NULL) fun = (SEXP (*)(Network *)) R_FindSymbol("Network2Redgelist", "ergm", NULL);
@@ -353,6 +368,26 @@ fun(n_edges,tails,heads,nwp,m);
 #include <R_ext/Rdynload.h>
 #include "ergm_rlebdm.h"
 
+#define STUBFILE
+#include <stddef.h>
+#include <R_ext/Rdynload.h>
+#include "ergm_rng.h"
+ErgmRNG * ErgmRNGInitialize(ErgmRNGMode mode){
+static ErgmRNG * (*fun)(ErgmRNGMode) = NULL;
+if(fun==NULL) fun = (ErgmRNG * (*)(ErgmRNGMode)) R_FindSymbol("ErgmRNGInitialize", "ergm", NULL);
+return fun(mode);
+}
+void ErgmRNGDestroy(ErgmRNG *rng){
+static void (*fun)(ErgmRNG *) = NULL;
+if(fun==NULL) fun = (void (*)(ErgmRNG *)) R_FindSymbol("ErgmRNGDestroy", "ergm", NULL);
+fun(rng);
+}
+void ErgmRNGFill(ErgmRNG *rng){
+static void (*fun)(ErgmRNG *) = NULL;
+if(fun==NULL) fun = (void (*)(ErgmRNG *)) R_FindSymbol("ErgmRNGFill", "ergm", NULL);
+fun(rng);
+}
+
 #define STUBFILE
 #include <stddef.h>
 #include <R_ext/Rdynload.h>
@@ -407,6 +442,21 @@ static WtNetwork * (*fun)(WtNetwork *) = NULL;
 if(fun==NULL) fun = (WtNetwork * (*)(WtNetwork *)) R_FindSymbol("WtNetworkCopy", "ergm", NULL);
 return fun(src);
 }
+Rboolean WtNetworkSetWeightType(WtNetwork *nwp, WtWeightType wttype){
+static Rboolean (*fun)(WtNetwork *,WtWeightType) = NULL;
+if(fun==NULL) fun = (Rboolean (*)(WtNetwork *,WtWeightType)) R_FindSymbol("WtNetworkSetWeightType", "ergm", NULL);
+return fun(nwp,wttype);
+}
+void WtNetworkCompact(WtNetwork *nwp){
+static void (*fun)(WtNetwork *) = NULL;
+if(fun==NULL) fun = (void (*)(WtNetwork *)) R_FindSymbol("WtNetworkCompact", "ergm", NULL);
+fun(nwp);
+}
+void WtNetworkGetEdgetreeStats(WtNetwork *nwp, EdgetreeStats *stats){
+static void (*fun)(WtNetwork *,EdgetreeStats *) = NULL;
+if(fun==NULL) fun = (void (*)(WtNetwork *,EdgetreeStats *)) R_FindSymbol("WtNetworkGetEdgetreeStats", "ergm", NULL);
+fun(nwp,stats);
+}
 SEXP WtNetwork2Redgelist(WtNetwork *nwp){
 static SEXP (*fun)(WtNetwork *) = NULL;
 if(fun==NULL) fun = (SEXP (*)(WtNetwork *)) R_FindSymbol("WtNetwork2Redgelist", "ergm", NULL);
@@ -457,6 +507,11 @@ static int (*fun)(Vertex *,Vertex *,double *,WtNetwork *) = NULL;
 if(fun==NULL) fun = (int (*)(Vertex *,Vertex *,double *,WtNetwork *)) R_FindSymbol("WtGetRandEdge", "ergm", NULL);
 return fun(tail,head,weight,nwp);
 }
+int WtGetRandEdgeRNG(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp, ErgmRNG *rng){
+static int (*fun)(Vertex *,Vertex *,double *,WtNetwork *,ErgmRNG *) = NULL;
+if(fun==NULL) fun = (int (*)(Vertex *,Vertex *,double *,WtNetwork *,ErgmRNG *)) R_FindSymbol("WtGetRandEdgeRNG", "ergm", NULL);
+return fun(tail,head,weight,nwp,rng);
+}
 int WtFindithNonedge(Vertex *tail, Vertex *head, Dyad i, WtNetwork *nwp){
 static int (*fun)(Vertex *,Vertex *,Dyad,WtNetwork *) = NULL;
 if(fun==NULL) fun = (int (*)(Vertex *,Vertex *,Dyad,WtNetwork *)) R_FindSymbol("WtFindithNonedge", "ergm", NULL);
@@ -577,6 +632,11 @@ static SEXP (*fun)(WtErgmState *) = NULL;
 if(fun==NULL) fun = (SEXP (*)(WtErgmState *)) R_FindSymbol("WtErgmStateRSave", "ergm", NULL);
 return fun(s);
 }
+WtErgmState * WtErgmStateClone(WtErgmState *s,unsigned int flags){
+static WtErgmState * (*fun)(WtErgmState *,unsigned int) = NULL;
+if(fun==NULL) fun = (WtErgmState * (*)(WtErgmState *,unsigned int)) R_FindSymbol("WtErgmStateClone", "ergm", NULL);
+return fun(s,flags);
+}
 void WtErgmStateDestroy(WtErgmState *s){
 static void (*fun)(WtErgmState *) = NULL;
 if(fun==NULL) fun = (void (*)(WtErgmState *)) R_FindSymbol("WtErgmStateDestroy", "ergm", NULL);
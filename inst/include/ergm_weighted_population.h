@@ -14,15 +14,38 @@
 #include <R.h>
 
 /*
-   This is a data structure for weighted sampling. There are two supported types:
+   This is a data structure for weighted sampling. There are three supported types:
    - 'B' for binary tree, with O(log n) time to sample a category and O(log n)
-     time to update a category weight, and
+     time to update a category weight,
    - 'W' for Walker's alias method, with O(1) time to sample a category and O(n)
-     time to update a category weight.
+     time to update a category weight, and
+   - 'D' for dynamic weight classes, with O(1) expected time to sample a category
+     and O(1) time to update a category weight (see below).
 */
 
+/*
+   The 'D' type partitions the categories into WTPOP_NCLASSES weight classes
+   by powers of two below a bound M on the weights: class k holds the weights
+   in [M/2^(k + 1), M/2^k), except that the last class also holds any smaller
+   positive weights, and a final extra class holds the zero weights. The
+   categories are kept in a single array (members), grouped by class, with
+   class k occupying positions start[k] to start[k + 1] - 1.
+
+   A class is sampled in proportion to its total weight, by a linear scan that
+   starts from the heaviest class; a category within it is sampled uniformly
+   and accepted with probability weight/(M/2^k), which is at least 1/2 for all
+   but the last class (sampled by scanning instead). Changing a weight moves
+   the category between classes, shifting the boundaries of the classes in
+   between, so costs at most WTPOP_NCLASSES swaps. Setting a weight of M or
+   more rebins everything with a larger M.
+
+   All of this state lives in one allocation, pointed to by block.
+*/
+#define WTPOP_NCLASSES 64
+
 typedef struct {
-  // type is either 'B' for binary tree or 'W' for Walker's alias method
+  // type is either 'B' for binary tree, 'W' for Walker's alias method,
+  // or 'D' for dynamic weight classes
   char type; 
 
   // binary tree state
@@ -35,8 +58,106 @@ typedef struct {
   int *alias;
   double *originalweights;
   double sum;
+
+  // dynamic weight class state (size and sum are shared with Walker)
+  void *block;
+  double bound;
+  double *dweights;
+  double *totals;
+  int *members;
+  int *pos;
+  int *wtclass;
+  int *start;
 } WtPop;
 
+// weight class of weight for the 'D' type
+static inline int WtPopDClass(double weight, WtPop *wtp) {
+  if(weight == 0) {
+    return WTPOP_NCLASSES;
+  }
+  double r = weight/wtp->bound;
+  if(r == 0) {
+    return WTPOP_NCLASSES - 1; // underflow
+  }
+  int e;
+  frexp(r, &e);
+  return -e < WTPOP_NCLASSES - 1 ? -e : WTPOP_NCLASSES - 1;
+}
+
+// swap the categories at positions i and j of the 'D' type's members array
+static inline void WtPopDSwap(int i, int j, WtPop *wtp) {
+  int a = wtp->members[i];
+  int b = wtp->members[j];
+  wtp->members[i] = b;
+  wtp->pos[b] = i;
+  wtp->members[j] = a;
+  wtp->pos[a] = j;
+}
+
+// move category position of the 'D' type to weight class to, shifting the
+// boundaries of the classes in between
+static inline void WtPopDMove(int position, int to, WtPop *wtp) {
+  int from = wtp->wtclass[position];
+  if(from < to) {
+    WtPopDSwap(wtp->pos[position], wtp->start[from + 1] - 1, wtp);
+    for(int k = from + 1; k <= to; k++) {
+      wtp->start[k]--;
+      if(k < to) {
+        WtPopDSwap(wtp->start[k], wtp->start[k + 1] - 1, wtp);
+      }
+    }
+  } else if(from > to) {
+    WtPopDSwap(wtp->pos[position], wtp->start[from], wtp);
+    for(int k = from; k > to; k--) {
+      wtp->start[k]++;
+      if(k - 1 > to) {
+        WtPopDSwap(wtp->start[k] - 1, wtp->start[k - 1], wtp);
+      }
+    }
+  }
+  wtp->wtclass[position] = to;
+}
+
+// (re)compute the weight classes of the 'D' type for the weights in dweights,
+// with the bound chosen to exceed all of them
+static inline void WtPopDBin(WtPop *wtp) {
+  double max = 0;
+  for(int i = 0; i < wtp->size; i++) {
+    max = fmax(max, wtp->dweights[i]);
+  }
+  int e;
+  frexp(max, &e);
+  wtp->bound = ldexp(1, e);
+
+  memset(wtp->totals, 0, WTPOP_NCLASSES*sizeof(double));
+  memset(wtp->start, 0, (WTPOP_NCLASSES + 2)*sizeof(int));
+
+  // counting sort of the categories by class
+  for(int i = 0; i < wtp->size; i++) {
+    wtp->wtclass[i] = WtPopDClass(wtp->dweights[i], wtp);
+    wtp->start[wtp->wtclass[i] + 1]++;
+    if(wtp->wtclass[i] < WTPOP_NCLASSES) {
+      wtp->totals[wtp->wtclass[i]] += wtp->dweights[i];
+    }
+  }
+  for(int k = 0; k <= WTPOP_NCLASSES; k++) {
+    wtp->start[k + 1] += wtp->start[k];
+  }
+  for(int i = 0; i < wtp->size; i++) {
+    wtp->pos[i] = wtp->start[wtp->wtclass[i]]++;
+    wtp->members[wtp->pos[i]] = i;
+  }
+  for(int k = WTPOP_NCLASSES; k > 0; k--) {
+    wtp->start[k] = wtp->start[k - 1];
+  }
+  wtp->start[0] = 0;
+
+  wtp->sum = 0;
+  for(int k = 0; k < WTPOP_NCLASSES; k++) {
+    wtp->sum += wtp->totals[k];
+  }
+}
+
 // constructor; weights should be an array of length size, consisting of
 // non-negative numbers, with at least one strictly positive
 static inline WtPop *WtPopInitialize(int size, double *weights, char type) {
@@ -125,8 +246,28 @@ static inline WtPop *WtPopInitialize(int size, double *weights, char type) {
         wtp->prob[j] = 1;
       }
     }
+  } else if(type == 'D') {
+    wtp->type = 'D';
+    wtp->size = size;
+
+    // doubles first, so that everything is aligned
+    wtp->block = Calloc((size + WTPOP_NCLASSES)*sizeof(double)
+                        + (3*size + WTPOP_NCLASSES + 2)*sizeof(int), char);
+    wtp->dweights = (double *) wtp->block;
+    wtp->totals = wtp->dweights + size;
+    wtp->members = (int *) (wtp->totals + WTPOP_NCLASSES);
+    wtp->pos = wtp->members + size;
+    wtp->wtclass = wtp->pos + size;
+    wtp->start = wtp->wtclass + size;
+
+    memcpy(wtp->dweights, weights, size*sizeof(double));
+    WtPopDBin(wtp);
+
+    if(wtp->sum == 0) {
+      error("cannot initialize weighted population with zero total weight");
+    }
   } else {
-    error("unsupported weighted population type; options are 'B' for binary tree and 'W' for Walker");
+    error("unsupported weighted population type; options are 'B' for binary tree, 'W' for Walker, and 'D' for dynamic weight classes");
   }
 
   return wtp;
@@ -139,6 +280,8 @@ static inline void WtPopDestroy(WtPop *wtp) {
       Free(wtp->weights[i]);
     }
     Free(wtp->weights);
+  } else if(wtp->type == 'D') {
+    Free(wtp->block);
   } else {
     Free(wtp->prob);
     Free(wtp->alias);
@@ -162,6 +305,52 @@ static inline int WtPopGetRand(WtPop *wtp) {
       }
     }
     return j;
+  } else if(wtp->type == 'D') {
+    // pick a class in proportion to its total weight; if roundoff
+    // takes us past the end, use the last nonempty class
+    double s = unif_rand()*wtp->sum;
+    int k = 0, last = -1;
+    for(; k < WTPOP_NCLASSES; k++) {
+      if(wtp->start[k + 1] > wtp->start[k]) {
+        if(s < wtp->totals[k]) {
+          break;
+        }
+        last = k;
+      }
+      s -= wtp->totals[k];
+    }
+    if(k == WTPOP_NCLASSES) {
+      k = last;
+    }
+
+    int first = wtp->start[k];
+    int count = wtp->start[k + 1] - first;
+
+    if(k < WTPOP_NCLASSES - 1) {
+      // rejection sampling within the class
+      double bound = ldexp(wtp->bound, -k);
+      while(TRUE) {
+        int i = wtp->members[first + (int) (unif_rand()*count)];
+        if(unif_rand()*bound < wtp->dweights[i]) {
+          return i;
+        }
+      }
+    } else {
+      // the last class can have arbitrarily small weights, so scan it
+      double total = 0;
+      for(int j = 0; j < count; j++) {
+        total += wtp->dweights[wtp->members[first + j]];
+      }
+      s = unif_rand()*total;
+      for(int j = 0; j < count - 1; j++) {
+        int i = wtp->members[first + j];
+        if(s < wtp->dweights[i]) {
+          return i;
+        }
+        s -= wtp->dweights[i];
+      }
+      return wtp->members[first + count - 1];
+    }
   } else {
     double s = unif_rand()*wtp->size;
     int i = (int) s;
@@ -183,6 +372,37 @@ static inline void WtPopSetWt(int position, double weight, WtPop *wtp) {
       wtp->weights[i][j] += change;
       j /= 2;
     }
+  } else if(wtp->type == 'D') {
+    double old = wtp->dweights[position];
+    wtp->dweights[position] = weight;
+
+    if(weight >= wtp->bound) {
+      WtPopDBin(wtp);
+      return;
+    }
+
+    int from = wtp->wtclass[position];
+    int to = WtPopDClass(weight, wtp);
+    if(from < WTPOP_NCLASSES) {
+      wtp->totals[from] -= old;
+    }
+    if(to < WTPOP_NCLASSES) {
+      wtp->totals[to] += weight;
+    }
+    wtp->sum += weight - old;
+    WtPopDMove(position, to, wtp);
+
+    // keep roundoff from accumulating in emptied classes, and recompute
+    // the sum if removing the old weight may have cancelled most of it
+    if(from < WTPOP_NCLASSES && wtp->start[from + 1] == wtp->start[from]) {
+      wtp->totals[from] = 0;
+    }
+    if(old > wtp->sum) {
+      wtp->sum = 0;
+      for(int k = 0; k < WTPOP_NCLASSES; k++) {
+        wtp->sum += wtp->totals[k];
+      }
+    }
   } else {
     wtp->originalweights[position] = weight;
     WtPop *new_wtp = WtPopInitialize(wtp->size, wtp->originalweights, 'W');
@@ -198,6 +418,8 @@ static inline void WtPopSetWt(int position, double weight, WtPop *wtp) {
 static inline double WtPopGetWt(int position, WtPop *wtp) {
   if(wtp->type == 'B') {
     return wtp->weights[wtp->height][position];
+  } else if(wtp->type == 'D') {
+    return wtp->dweights[position];
   } else {
     return wtp->originalweights[position];
   }
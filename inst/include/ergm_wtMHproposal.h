@@ -12,6 +12,7 @@
 
 #include "ergm_wtedgetree.h"
 #include "R_ext/Rdynload.h"
+#include "ergm_rng.h"
 
 #define NO_EDGE       0x00 /*these four used in realocateWithReplacement */
 #define OLD_EDGE      0x01 
@@ -72,6 +73,12 @@ typedef struct WtMHProposalstruct {
   void **aux_storage;
   unsigned int n_aux;
   unsigned int *aux_slots;
+  ErgmRNG *rng; /* source of uniforms for the proposal; see ergm_rng.h */
+  Rboolean compact; /* if TRUE, the MCMC sampler periodically rebuilds the edgetrees of the network; see WtNetworkCompact() */
+  Rboolean thread_safe; /* set by the proposal's initializer if it draws random numbers only through MH_UNIF_RAND() and the other MH_ macros below, calls no R API other than Rmath while proposing, and keeps no static state, so that, given an rng, it can propose off the main thread */
+  unsigned int gibbs; /* if nonzero, the MCMC sampler may treat the proposed toggles as a block of distinct dyads and draw each one's value from its full conditional distribution over the gibbs values in gibbs_values instead */
+  double *gibbs_values;
+  double *gibbs_logh; /* log of the reference measure at each of gibbs_values */
 } WtMHProposal;
 
 WtMHProposal *WtMHProposalInitialize(SEXP pR, WtNetwork *nwp, void **aux_storage);
@@ -83,6 +90,21 @@ void WtMHProposalDestroy(WtMHProposal *MH, WtNetwork *nwp);
 #define MH_INPUTS MH_DINPUTS
 #define MH_IINPUTS MHp->iinputs
 
+/* A Uniform(0,1) draw from the proposal's generator. */
+#define MH_UNIF_RAND() ErgmRNGUnif(MHp->rng)
+
+/* Random draws for the proposals. If the proposal has its own
+   generator, they are obtained from it (by inversion where needed),
+   so that the proposal does not touch R's generator at all and
+   chains with separate generators can run in parallel; otherwise,
+   they are exactly R's. */
+#define MH_RUNIF(a, b) (MHp->rng ? (a) + ((b)-(a))*MH_UNIF_RAND() : runif((a), (b)))
+#define MH_RNORM(mu, sigma) (MHp->rng ? qnorm(MH_UNIF_RAND(), (mu), (sigma), TRUE, FALSE) : rnorm((mu), (sigma)))
+#define MH_RPOIS(mu) (MHp->rng ? qpois(MH_UNIF_RAND(), (mu), TRUE, FALSE) : rpois(mu))
+#define MH_RBINOM(n, p) (MHp->rng ? qbinom(MH_UNIF_RAND(), (n), (p), TRUE, FALSE) : rbinom((n), (p)))
+#define MH_GetRandDyad(tail, head, nwp) GetRandDyadUnif(tail, head, nwp, MH_UNIF_RAND())
+#define MH_WtGetRandEdge(tail, head, weight, nwp) WtGetRandEdgeRNG((tail), (head), (weight), (nwp), MHp->rng)
+
 #define Mtail (MHp->toggletail)
 #define Mhead (MHp->togglehead)
 #define Mweight (MHp->toggleweight)
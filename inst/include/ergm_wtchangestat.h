@@ -76,8 +76,8 @@ typedef struct WtModelTermstruct {
 /* The OUTWT and INWT macros give the weight of edge e, depending
    on whether it is an in-edge or an out-edge.  Presumably the first endnode
    of the edge is already known in this context. */
-#define OUTWT(e) (nwp->outedges[(e)].weight)
-#define INWT(e) (nwp->inedges[(e)].weight)
+#define OUTWT(e) (WtWeightGet(nwp->outweights, nwp->wttype, (e)))
+#define INWT(e) (WtWeightGet(nwp->inweights, nwp->wttype, (e)))
 
 /* Return each of the out-neighbors or in-neighbors, one at a time,
    of node a.  At each iteration of the loop, the variable v gives the node 
@@ -10,18 +10,32 @@
 #ifndef _ERGM_WTEDGETREE_H_
 #define _ERGM_WTEDGETREE_H_
 
+#include <stdint.h>
 #include "ergm_edgetree_common.do_not_include_directly.h"
+#include "ergm_rng.h"
 
-/* WtTreeNode is just like TreeNode but with an extra field for a
-   weight, or value, that might be associated with the node */
+/* WtTreeNode is just like TreeNode; the weight, or value, associated
+   with the node is kept in the corresponding element of the
+   network's outweights or inweights array, so that its width does not
+   pad out every node. */
 typedef struct WtTreeNodestruct {
   Vertex value;      /*  the vertex at the other end of the edge  */
   Edge parent;   /*  parent of this node in the tree (0 for root) */
   Edge left;     /*  left child (0 if none)  */
   Edge right;    /*  right child (0 if none) */
-  double weight;
 } WtTreeNode;
 
+/* How the weights of a WtNetwork are stored. WT_DOUBLE, the default,
+   can hold any value; the integer types can only hold integers in
+   their range, and WT_FLOAT rounds to single precision. */
+typedef enum WtWeightTypeenum {
+  WT_DOUBLE = 0,
+  WT_FLOAT = 1,
+  WT_INT32 = 2,
+  WT_UINT16 = 3,
+  WT_UINT8 = 4
+} WtWeightType;
+
 /* WtNetwork is a structure just like Network except it is for a network with 
    weighted (valued) edges.  */
 typedef struct WtNetworkstruct {
@@ -42,6 +56,10 @@ typedef struct WtNetworkstruct {
   unsigned int max_on_edge_change;
   void (**on_edge_change)(Vertex, Vertex, double, void*, struct WtNetworkstruct*, double);
   void **on_edge_change_payload;
+
+  WtWeightType wttype;
+  void *inweights;
+  void *outweights;
 } WtNetwork;
 typedef void (*OnWtNetworkEdgeChange)(Vertex, Vertex, double, void*, WtNetwork*, double);
 
@@ -56,6 +74,10 @@ WtNetwork *WtNetworkInitializeD(double *tails, double *heads, double *weights, E
 
 WtNetwork *WtNetworkCopy(WtNetwork *src);
 
+Rboolean WtNetworkSetWeightType(WtNetwork *nwp, WtWeightType wttype);
+void WtNetworkCompact(WtNetwork *nwp);
+void WtNetworkGetEdgetreeStats(WtNetwork *nwp, EdgetreeStats *stats);
+
 SEXP WtNetwork2Redgelist(WtNetwork *nwp);
 WtNetwork *Redgelist2WtNetwork(SEXP elR, Rboolean empty);
 
@@ -91,6 +113,7 @@ void DeleteOnWtNetworkEdgeChange(WtNetwork *nwp, OnWtNetworkEdgeChange callback,
 /* Utility functions. */
 int WtFindithEdge (Vertex *tail, Vertex *head, double *weight, Edge i, WtNetwork *nwp);
 int WtGetRandEdge(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp);
+int WtGetRandEdgeRNG(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp, ErgmRNG *rng);
 int WtFindithNonedge (Vertex *tail, Vertex *head, Dyad i, WtNetwork *nwp);
 int WtGetRandNonedge(Vertex *tail, Vertex *head, WtNetwork *nwp);
 void Wtprintedge(Edge e, WtTreeNode *edges);
@@ -12,6 +12,53 @@
        such, the function definitions now require tails to be passed
        in before heads */
 
+/*****************
+ double WtWeightGet, void WtWeightPut, Rboolean WtWeightFits
+
+ Read or write the eth element of an array of weights stored as
+ wttype, and check whether weight w can be stored as wttype without
+ loss (except for WT_FLOAT, which accepts any value and rounds it).
+*****************/
+static inline double WtWeightGet(const void *weights, WtWeightType wttype, Edge e){
+  switch(wttype){
+  case WT_UINT8: return ((const uint8_t *) weights)[e];
+  case WT_UINT16: return ((const uint16_t *) weights)[e];
+  case WT_INT32: return ((const int32_t *) weights)[e];
+  case WT_FLOAT: return ((const float *) weights)[e];
+  default: return ((const double *) weights)[e];
+  }
+}
+
+static inline void WtWeightPut(void *weights, WtWeightType wttype, Edge e, double w){
+  switch(wttype){
+  case WT_UINT8: ((uint8_t *) weights)[e] = w; break;
+  case WT_UINT16: ((uint16_t *) weights)[e] = w; break;
+  case WT_INT32: ((int32_t *) weights)[e] = w; break;
+  case WT_FLOAT: ((float *) weights)[e] = w; break;
+  default: ((double *) weights)[e] = w;
+  }
+}
+
+static inline size_t WtWeightSize(WtWeightType wttype){
+  switch(wttype){
+  case WT_UINT8: return sizeof(uint8_t);
+  case WT_UINT16: return sizeof(uint16_t);
+  case WT_INT32: return sizeof(int32_t);
+  case WT_FLOAT: return sizeof(float);
+  default: return sizeof(double);
+  }
+}
+
+// Note that NaN fails all comparisons, so only the floating-point types accept it.
+static inline Rboolean WtWeightFits(WtWeightType wttype, double w){
+  switch(wttype){
+  case WT_UINT8: return w >= 0 && w <= UINT8_MAX && w == (uint8_t) w;
+  case WT_UINT16: return w >= 0 && w <= UINT16_MAX && w == (uint16_t) w;
+  case WT_INT32: return w >= INT32_MIN && w <= INT32_MAX && w == (int32_t) w;
+  default: return TRUE;
+  }
+}
+
 /*****************
  Edge WtEdgetreeSearch
 
@@ -138,7 +185,7 @@ static inline double WtGetEdge (Vertex tail, Vertex head, WtNetwork *nwp)
   ENSURE_TH_ORDER;
 
   Edge oe=WtEdgetreeSearch(tail,head,nwp->outedges);
-  if(oe) return nwp->outedges[oe].weight;
+  if(oe) return WtWeightGet(nwp->outweights, nwp->wttype, oe);
   else return 0;
 }
 
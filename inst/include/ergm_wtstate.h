@@ -23,10 +23,13 @@ typedef struct{
   WtModel *m;
   WtMHProposal *MHp;
   SEXP save;
+  unsigned int mh_unsuccessful; /* unsuccessful proposals in a parallel region, to be warned about by the caller */
 } WtErgmState;
 
 WtErgmState *WtErgmStateInit(SEXP stateR,
                              unsigned int flags);
+WtErgmState *WtErgmStateClone(WtErgmState *s,
+                              unsigned int flags);
 SEXP WtErgmStateRSave(WtErgmState *s);
 void WtErgmStateDestroy(WtErgmState *s);
 SEXP WtErgmStateArrayClear();
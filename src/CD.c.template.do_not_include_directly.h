@@ -230,7 +230,7 @@ MCMCStatus DISPATCH_CDStep(DISPATCH_ErgmState *s,
     }
     
     /* if we accept the proposed network */
-    if (cutoff >= 0.0 || logf(unif_rand()) < cutoff) { 
+    if (cutoff >= 0.0 || logf(MH_UNIF_RAND()) < cutoff) { 
       if(verbose>=5){
 	Rprintf("Accepted.\n");
       }
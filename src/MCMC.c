@@ -8,4 +8,103 @@
  *  Copyright 2003-2022 Statnet Commons
  */
 #include "MCMC.h"
+#include "ergm_util.h"
+#include "ergm_nodeswap.h"
+
+/*********************
+ int GibbsBlockStep
+
+ Draws the configuration of the block of distinct dyads given by the
+ proposed toggles from its full conditional distribution, adding the
+ change statistics to networkstatistics. The 2^ntoggles configurations
+ are visited in Gray code order, so that each differs from the
+ previous one by a single toggle; then the network is moved to the
+ one drawn. Returns whether the configuration changed.
+*********************/
+static int GibbsBlockStep(MHProposal *MHp, Network *nwp, Model *m,
+                          double *eta, double *networkstatistics, int verbose){
+  unsigned int k = MHp->ntoggles, nconf = 1u << k;
+  double *w = Calloc(nconf, double);
+  double *cum = Calloc((size_t) nconf*m->n_stats, double);
+  unsigned int *gray = Calloc(nconf, unsigned int);
+
+  double maxw = 0;
+  for(unsigned int c = 1; c < nconf; c++){
+    unsigned int bit = 0;
+    while(!(c & (1u << bit))) bit++;
+    Vertex tail = MHp->toggletail[bit], head = MHp->togglehead[bit];
+
+    ChangeStats1(tail, head, nwp, m, IS_OUTEDGE(tail, head));
+    memcpy(cum + c*m->n_stats, cum + (c-1)*m->n_stats, m->n_stats*sizeof(double));
+    addonto(cum + c*m->n_stats, m->workspace, m->n_stats);
+    ToggleEdge(tail, head, nwp);
+    gray[c] = gray[c-1] ^ (1u << bit);
+
+    /* As in the MH step, a NaN log-weight (e.g., from 0*Inf) makes the
+       configuration impossible. */
+    w[c] = dotprod(eta, cum + c*m->n_stats, m->n_stats);
+    if(ISNAN(w[c])) w[c] = R_NegInf;
+    maxw = fmax(maxw, w[c]);
+  }
+
+  double total = 0;
+  for(unsigned int c = 0; c < nconf; c++){
+    w[c] = exp(w[c] - maxw);
+    total += w[c];
+  }
+  double u = MH_UNIF_RAND()*total;
+  unsigned int c = 0;
+  while(c < nconf-1 && u >= w[c]){
+    u -= w[c];
+    c++;
+  }
+
+  if(verbose>=5){
+    Rprintf("Gibbs block of %u dyads: drew configuration %u.\n", k, gray[c]);
+  }
+
+  unsigned int diff = gray[nconf-1] ^ gray[c];
+  for(unsigned int bit = 0; bit < k; bit++)
+    if(diff & (1u << bit)) ToggleEdge(MHp->toggletail[bit], MHp->togglehead[bit], nwp);
+  addonto(networkstatistics, cum + c*m->n_stats, m->n_stats);
+
+  int changed = gray[c] != 0;
+  Free(w);
+  Free(cum);
+  Free(gray);
+  return changed;
+}
+
+/*********************
+ int NodeSwapChangeStats
+
+ For a proposal exchanging the labels of two vertices, asks each term
+ with statistics to compute its change directly (see
+ ergm_nodeswap.h), leaving the result in m->workspace. Returns FALSE
+ as soon as a term cannot, in which case the caller must evaluate the
+ proposed toggles instead.
+*********************/
+static int NodeSwapChangeStats(MHProposal *MHp, Network *nwp, Model *m){
+  ErgmNodeSwap ns = {.v1 = MHp->nodeswap[0], .v2 = MHp->nodeswap[1]};
+  memset(m->workspace, 0, m->n_stats*sizeof(double));
+
+  int ok = TRUE;
+  unsigned int i = 0;
+  EXEC_THROUGH_TERMS_INTO(m, m->workspace, {
+      if(ok && mtp->nstats){
+        if(mtp->x_func){
+          mtp->dstats = dstats;
+          ns.mtp = mtp;
+          ns.handled = FALSE;
+          (*(mtp->x_func))(ERGM_NODESWAP_SIGNAL, &ns, mtp, nwp);
+          mtp->dstats = m->dstatarray[i];
+        }
+        if(!mtp->x_func || !ns.handled) ok = FALSE;
+      }
+      i++;
+    });
+
+  return ok;
+}
+
 #include "MCMC.c.template.do_not_include_directly.h"
@@ -9,6 +9,13 @@
  */
 #include "ergm_etamap.h"
 #include "ergm_util.h"
+#ifdef _OPENMP
+#include <omp.h>
+/* Only the main thread may talk to R. */
+#define MCMC_ON_MAIN_THREAD (!omp_in_parallel())
+#else
+#define MCMC_ON_MAIN_THREAD TRUE
+#endif
 /*****************
  Note on undirected networks:  For j<k, edge {j,k} should be stored
  as (j,k) rather than (k,j).  In other words, only directed networks
@@ -71,6 +78,34 @@ SEXP DISPATCH_MCMC_wrapper(SEXP stateR,
 }
 
 
+/*********************
+ void MCMCCompactIfDue
+
+ If the proposal requests it (see the ergm.proposal.compact option),
+ rebuild the edgetrees of the network (see NetworkCompact()) once
+ the number of steps accepted since the last rebuild, *naccepted,
+ reaches the number of edges and vertices, so that the linear cost
+ of the rebuild is spread over the toggles that degraded the layout.
+ Since this moves the edges to different TreeNodes, it is off by
+ default.
+*********************/
+static inline void MCMCCompactIfDue(DISPATCH_ErgmState *s, unsigned long *naccepted, int verbose){
+  DISPATCH_Network *nwp = s->nwp;
+  if(!s->MHp->compact || *naccepted < (unsigned long) EDGECOUNT(nwp) + nwp->nnodes) return;
+  *naccepted = 0;
+
+  EdgetreeStats before, after;
+  if(verbose>=4) DISPATCH_NetworkGetEdgetreeStats(nwp, &before);
+  DISPATCH_NetworkCompact(nwp);
+  if(verbose>=4){
+    DISPATCH_NetworkGetEdgetreeStats(nwp, &after);
+    Rprintf("Compacted edgetrees: span %u -> %u of %u -> %u TreeNodes, mean depth %.2f -> %.2f (balanced %.2f), contiguous %.2f -> %.2f.\n",
+            before.span, after.span, before.capacity, after.capacity,
+            before.depth, after.depth, after.mindepth,
+            before.contiguous, after.contiguous);
+  }
+}
+
 /*********************
  void DISPATCH_MCMCSample
 
@@ -89,6 +124,7 @@ MCMCStatus DISPATCH_MCMCSample(DISPATCH_ErgmState *s,
   DISPATCH_Model *m = s->m;
 
   int staken, tottaken;
+  unsigned long naccepted;
 
   /*********************
   networkstatistics are modified in groups of m->n_stats, and they
@@ -115,6 +151,8 @@ MCMCStatus DISPATCH_MCMCSample(DISPATCH_ErgmState *s,
   if(nmax!=0 && EDGECOUNT(nwp) >= nmax-1){
     return MCMC_TOO_MANY_EDGES;
   }
+  naccepted = staken;
+  MCMCCompactIfDue(s, &naccepted, verbose);
 
   if(s->save){
     s->stats = networkstatistics;
@@ -143,6 +181,8 @@ MCMCStatus DISPATCH_MCMCSample(DISPATCH_ErgmState *s,
       if(nmax!=0 && EDGECOUNT(nwp) >= nmax-1){
 	return MCMC_TOO_MANY_EDGES;
       }
+      naccepted += staken;
+      MCMCCompactIfDue(s, &naccepted, verbose);
 
       if(s->save){
         s->stats = networkstatistics;
@@ -151,7 +191,7 @@ MCMCStatus DISPATCH_MCMCSample(DISPATCH_ErgmState *s,
 
       tottaken += staken;
 
-      R_CheckUserInterrupt();
+      if(MCMC_ON_MAIN_THREAD) R_CheckUserInterrupt();
 #ifdef Win32
       if( ((100*i) % samplesize)==0 && samplesize > 500){
 	R_FlushConsole();
@@ -207,17 +247,19 @@ MCMCStatus DISPATCH_MetropolisHastings (DISPATCH_ErgmState *s,
     if(MHp->toggletail[0]==MH_FAILED){
       switch(MHp->togglehead[0]){
       case MH_UNRECOVERABLE:
+	if(!MCMC_ON_MAIN_THREAD) return MCMC_MH_FAILED;
 	error("Something very bad happened during proposal. Memory has not been deallocated, so restart R soon.");
 
       case MH_IMPOSSIBLE:
-	Rprintf("MH MHProposal function encountered a configuration from which no toggle(s) can be proposed.\n");
+	if(MCMC_ON_MAIN_THREAD) Rprintf("MH MHProposal function encountered a configuration from which no toggle(s) can be proposed.\n");
 	return MCMC_MH_FAILED;
 
       case MH_UNSUCCESSFUL:
-	warning("MH MHProposal function failed to find a valid proposal.");
+	if(MCMC_ON_MAIN_THREAD) warning("MH MHProposal function failed to find a valid proposal.");
+	else s->mh_unsuccessful++;
 	unsuccessful++;
 	if(unsuccessful>taken*MH_QUIT_UNSUCCESSFUL){
-	  Rprintf("Too many MH MHProposal function failures.\n");
+	  if(MCMC_ON_MAIN_THREAD) Rprintf("Too many MH MHProposal function failures.\n");
 	  return MCMC_MH_FAILED;
 	}
       case MH_CONSTRAINT:
@@ -225,6 +267,14 @@ MCMCStatus DISPATCH_MetropolisHastings (DISPATCH_ErgmState *s,
       }
     }
 
+#ifdef PROP_GIBBS
+    if(PROP_GIBBS){
+      /* Resample the block exactly instead of proposing to toggle it. */
+      if(GibbsBlockStep(MHp, nwp, m, eta, networkstatistics, verbose)) taken++;
+      continue;
+    }
+#endif
+
     if(verbose>=5){
       Rprintf("MHProposal: ");
       for(unsigned int i=0; i<MHp->ntoggles; i++) PROP_PRINT;
@@ -233,6 +283,10 @@ MCMCStatus DISPATCH_MetropolisHastings (DISPATCH_ErgmState *s,
 
     /* Calculate change statistics,
        remembering that tail -> head */
+#ifdef PROP_NODESWAP
+    /* Let the terms evaluate a relabeling directly if they all can. */
+    if(!PROP_NODESWAP || !NodeSwapChangeStats(MHp, nwp, m))
+#endif
     PROP_CHANGESTATS;
 
     if(verbose>=5){
@@ -255,7 +309,7 @@ MCMCStatus DISPATCH_MetropolisHastings (DISPATCH_ErgmState *s,
     }
 
     /* if we accept the proposed network */
-    if (cutoff >= 0.0 || logf(unif_rand()) < cutoff) { 
+    if (cutoff >= 0.0 || logf(MH_UNIF_RAND()) < cutoff) { 
       if(verbose>=5){
 	Rprintf("Accepted.\n");
       }
@@ -24,6 +24,8 @@
 #define DISPATCH_MetropolisHastings MetropolisHastings
 #define DISPATCH_MCMCPhase12 MCMCPhase12
 #define DISPATCH_MCMCSamplePhase12 MCMCSamplePhase12
+#define DISPATCH_NetworkCompact NetworkCompact
+#define DISPATCH_NetworkGetEdgetreeStats NetworkGetEdgetreeStats
 
 #include "MCMC.h.template.do_not_include_directly.h"
 
@@ -23,6 +23,7 @@ MHProposal *MHProposalInitialize(SEXP pR, Network *nwp, void **aux_storage){
   MHp->i_func=MHp->p_func=MHp->f_func=NULL;
   MHp->u_func=NULL;
   MHp->storage=NULL;
+  MHp->rng=NULL;
   
   /* Extract the required string information from the relevant sources */
   const char *fname = FIRSTCHAR(getListElement(pR, "name")),
@@ -70,6 +71,13 @@ MHProposal *MHProposalInitialize(SEXP pR, Network *nwp, void **aux_storage){
   if((MHp->n_aux = length(aux_slotsR))){
     MHp->aux_slots = (unsigned int *) INTEGER(aux_slotsR);
   }else MHp->aux_slots = NULL;
+
+  tmp = getListElement(pR, "rng");
+  MHp->rng = length(tmp) && !strcmp(FIRSTCHAR(tmp), "fast") ? ErgmRNGInitialize(ERGM_RNG_FAST) : NULL;
+  tmp = getListElement(pR, "edge.index");
+  MHp->edge_index = length(tmp) && asLogical(tmp) == TRUE;
+  tmp = getListElement(pR, "compact");
+  MHp->compact = length(tmp) && asLogical(tmp) == TRUE;
   
   MHp->ntoggles=0;
   if(MHp->i_func){
@@ -111,6 +119,7 @@ void MHProposalDestroy(MHProposal *MHp, Network *nwp){
     MHp->storage=NULL;
   }
   MHp->aux_storage=NULL;
+  if(MHp->rng) ErgmRNGDestroy(MHp->rng);
   Free(MHp->toggletail);
   Free(MHp->togglehead);
 
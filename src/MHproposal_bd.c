@@ -10,6 +10,20 @@
 #include "ergm_MHproposal_bd.h"
 #include "ergm_changestat.h"
 
+/*****************
+ void DegreeBoundUpdate
+
+ Network callback keeping the attribute degree counts current.
+*****************/
+static void DegreeBoundUpdate(Vertex tail, Vertex head, DegreeBound *bd, Network *nwp, Rboolean edgestate){
+  int delta = edgestate ? -1 : +1;
+  Vertex n = nwp->nnodes;
+  for(int k=0; k < bd->attrcount; k++){
+    if(bd->attribs[head-1 + k*n]) bd->outattr[tail-1 + k*n] += delta;
+    if(bd->attribs[tail-1 + k*n]) bd->inattr[head-1 + k*n] += delta;
+  }
+}
+
 /***********************
  DegreeBound* DegreeBoundInitializeR
 ************************/
@@ -90,6 +104,16 @@ DegreeBound* DegreeBoundInitialize(int *attribs, int *maxout, int *maxin,
 	  for (i=1;i<=nwp->nnodes;i++)
 	    bd->maxin[i-1] = bd->minin[i-1] = nwp->indegree[i];
 	}
+
+      /* initialize the attribute degree counts and keep them current */
+      bd->nwp = nwp;
+      bd->outattr = (int *) Calloc(nwp->nnodes*bd->attrcount, int);
+      bd->inattr = nwp->directed_flag ? (int *) Calloc(nwp->nnodes*bd->attrcount, int) : bd->outattr;
+      EXEC_THROUGH_NET_EDGES(t, h, e, {
+	  DegreeBoundUpdate(t, h, bd, nwp, FALSE);
+	});
+      AddOnNetworkEdgeChange(nwp, (OnNetworkEdgeChange) DegreeBoundUpdate, bd, INT_MAX);
+
       return bd;
     }
   else
@@ -105,6 +129,11 @@ DegreeBound* DegreeBoundInitialize(int *attribs, int *maxout, int *maxin,
 void DegreeBoundDestroy(DegreeBound *bd)
 {
   if(!bd) return;
+  if(bd->outattr){
+    DeleteOnNetworkEdgeChange(bd->nwp, (OnNetworkEdgeChange) DegreeBoundUpdate, bd);
+    if(bd->inattr != bd->outattr) Free(bd->inattr);
+    Free(bd->outattr);
+  }
   Free(bd->attribs);
   Free(bd->maxout);
   Free(bd->minout);
@@ -115,105 +144,76 @@ void DegreeBoundDestroy(DegreeBound *bd)
 
 
 /********************
- int CheckTogglesValid
-********************/
-int CheckTogglesValid(DegreeBound *bd, MHProposal *MHp, Network *nwp) {
-  int fvalid;
-  int i;
-
-  if(!bd) return 1;
-
-  /* *** don't forget when getting attributes that tail-> head */
-  int *tailattr = (int *) Calloc(bd->attrcount, int);
-  int *headattr = (int *) Calloc(bd->attrcount, int);
-
-  fvalid = 1;
-
-  /* Make proposed toggles */
-  for (i=0; i<MHp->ntoggles; i++)
-    ToggleEdge(MHp->toggletail[i], MHp->togglehead[i], nwp);
-
-  /*  Rprintf("fvalid %d bd->fBoundDegByAttr %d\n", fvalid, bd->fBoundDegByAttr); */
+ int DegreeBoundToggleDelta
 
-  /* if we're bounding degrees by attribute */
-  if (bd->fBoundDegByAttr && fvalid) {
-    int k;
-    if (nwp->directed_flag) {
-      /* for each tail and head pair */
-      for (i = 0; i < MHp->ntoggles && fvalid; i++) {
-        /* work through each attribute for each toggle */
-        for (k=0; k < bd->attrcount; k++){
-	        tailattr[k] = headattr[k] = 0;
-        }
-        /* calculate tail outdegree totals for each attribute
-        for each outedge of the tail 	      */
-
-        EXEC_THROUGH_FOUTEDGES(MHp->toggletail[i], e, v, {
-	    for (k=0; k < bd->attrcount; k++)
-	      if (bd->attribs[v-1 + k*nwp->nnodes]) tailattr[k]++;
-	  });
-
-        /* calculate head indegree totals for each attribute
-        for each inedge of the head */
-
-	EXEC_THROUGH_FINEDGES(MHp->togglehead[i], e, v, {
-	    for (k=0; k < bd->attrcount; k++)
-	      if (bd->attribs[v-1 + k*nwp->nnodes]) headattr[k]++;
-	  });
+ The change in the edge count of toggle i of the proposal, given that
+ the toggles before it have been made: -1 if it would remove an edge,
+ and +1 if it would add one.
+********************/
+static inline int DegreeBoundToggleDelta(int i, MHProposal *MHp, Network *nwp){
+  Vertex t = MHp->toggletail[i], h = MHp->togglehead[i];
+  if(!nwp->directed_flag && t > h){ Vertex tmp = t; t = h; h = tmp; }
+  int state = EdgetreeSearch(t, h, nwp->outedges) != 0;
+  for(int j=0; j < i; j++){
+    Vertex tj = MHp->toggletail[j], hj = MHp->togglehead[j];
+    if(!nwp->directed_flag && tj > hj){ Vertex tmp = tj; tj = hj; hj = tmp; }
+    if(tj == t && hj == h) state = !state;
+  }
+  return state ? -1 : +1;
+}
 
-        /* for each attribute */
+/********************
+ void DegreeBoundApplyToggles
 
-        for (k=0; k < bd->attrcount && fvalid; k++){
-          fvalid=!((tailattr[k]>bd->maxout[MHp->toggletail[i]-1+k*nwp->nnodes])||
-          (tailattr[k] < bd->minout[MHp->toggletail[i]-1+k*nwp->nnodes]) ||
-          (headattr[k] >  bd->maxin[MHp->togglehead[i]-1+k*nwp->nnodes]) ||
-          (headattr[k] <  bd->minin[MHp->togglehead[i]-1+k*nwp->nnodes]) );
-        }
-      }
+ Add (sign = +1) or back out (sign = -1) the effect of the proposed
+ toggles on the attribute degree counts.
+********************/
+static inline void DegreeBoundApplyToggles(DegreeBound *bd, MHProposal *MHp, Network *nwp, int sign){
+  Vertex n = nwp->nnodes;
+  for(int i=0; i < MHp->ntoggles; i++){
+    Vertex t = MHp->toggletail[i], h = MHp->togglehead[i];
+    if(t == 0 || h == 0) continue;
+    int delta = sign*DegreeBoundToggleDelta(i, MHp, nwp);
+    for(int k=0; k < bd->attrcount; k++){
+      if(bd->attribs[h-1 + k*n]) bd->outattr[t-1 + k*n] += delta;
+      if(bd->attribs[t-1 + k*n]) bd->inattr[h-1 + k*n] += delta;
     }
-    else { /* ! nwp->directed_flag  */
-      /* for each tail and head pair, (in that order: (tail, head)) */
-      for (i = 0; i < MHp->ntoggles && fvalid; i++) {
-        for (k=0; k < bd->attrcount; k++){
-	        tailattr[k] = headattr[k] = 0;
-	      }
+  }
+}
 
-	      /* calculate tail totals for each attribute
-        for each outedge and inedge of the tail  */
+/********************
+ int CheckTogglesValid
 
-	EXEC_THROUGH_EDGES(MHp->toggletail[i], e, v, {
-	    for (k=0; k < bd->attrcount; k++)
-	      if (bd->attribs[v-1 + k*nwp->nnodes])
-		tailattr[k]++;
-	  });
+ Checks whether the network after the proposed toggles would satisfy
+ the degree bounds at their endpoints. Rather than making the toggles
+ and recounting the endpoints' neighbors, which would also trigger
+ every other network callback twice, the toggles are applied to the
+ maintained attribute degree counts and then backed out.
+********************/
+int CheckTogglesValid(DegreeBound *bd, MHProposal *MHp, Network *nwp) {
+  int fvalid = 1;
 
-	      /* calculate head totals for each attribute
-        for each outedge and inedge of the head */
+  if(!bd || !bd->fBoundDegByAttr) return 1;
 
-	EXEC_THROUGH_EDGES(MHp->togglehead[i], e, v, {
-	    for (k=0; k < bd->attrcount; k++)
-	      if (bd->attribs[v-1 + k*nwp->nnodes])
-		headattr[k]++;
-	  });
+  Vertex n = nwp->nnodes;
+  int *maxhead = nwp->directed_flag ? bd->maxin : bd->maxout;
+  int *minhead = nwp->directed_flag ? bd->minin : bd->minout;
 
-	      /* for each attribute
-        check tails' and heads' outmax and outmin */
-	      for (k=0; k < bd->attrcount && fvalid; k++){
-          fvalid=!((tailattr[k]>bd->maxout[MHp->toggletail[i]-1+k*nwp->nnodes])||
-          (tailattr[k] < bd->minout[MHp->toggletail[i]-1+k*nwp->nnodes]) ||
-          (headattr[k] > bd->maxout[MHp->togglehead[i]-1+k*nwp->nnodes]) ||
-          (headattr[k] < bd->minout[MHp->togglehead[i]-1+k*nwp->nnodes]) );
-	      }
-	    }
+  DegreeBoundApplyToggles(bd, MHp, nwp, +1);
+
+  for(int i = 0; i < MHp->ntoggles && fvalid; i++) {
+    Vertex t = MHp->toggletail[i], h = MHp->togglehead[i];
+    if(t == 0 || h == 0) continue;
+    for(int k=0; k < bd->attrcount && fvalid; k++){
+      int tailattr = bd->outattr[t-1 + k*n], headattr = bd->inattr[h-1 + k*n];
+      fvalid=!((tailattr > bd->maxout[t-1 + k*n]) ||
+               (tailattr < bd->minout[t-1 + k*n]) ||
+               (headattr > maxhead[h-1 + k*n]) ||
+               (headattr < minhead[h-1 + k*n]));
     }
   }
 
-  Free(tailattr);
-  Free(headattr);
-
-  /* Undo proposed toggles (of edges(tail, head)) */
-  for (i=0; i<MHp->ntoggles; i++)
-    ToggleEdge(MHp->toggletail[i], MHp->togglehead[i], nwp);
+  DegreeBoundApplyToggles(bd, MHp, nwp, -1);
 
   return fvalid;
 }
@@ -74,7 +74,7 @@ MH_P_FN(Mp_TNT){
   Edge nedges = DyadGenEdgecount(storage->gen);
   double logratio=0;
   BD_LOOP(storage->bd, {
-      if (unif_rand() < P && nedges > 0) { /* Select a tie at random from the network of eligibles */
+      if (MH_UNIF_RAND() < P && nedges > 0) { /* Select a tie at random from the network of eligibles */
         DyadGenRandEdge(Mtail, Mhead, storage->gen);
 	logratio = TNT_LR_E(nedges, Q, DP, DO);
       }else{ /* Select a dyad at random from the list */
@@ -198,6 +198,36 @@ MH_I_FN(Mi_BDStratTNT) {
     }
   }
 
+  // compress the rows and columns of indmat to lists of the included
+  // strat mixing types, so that checking for changes in toggleability
+  // visits only those types rather than every level
+  sto->strat_rowstart = Calloc(sto->strat_nlevels + 1, int);
+  sto->strat_colstart = Calloc(sto->strat_nlevels + 1, int);
+  for(int i = 0; i < sto->strat_nlevels; i++) {
+    for(int j = 0; j < sto->strat_nlevels; j++) {
+      if(sto->indmat[i][j] >= 0) {
+        sto->strat_rowstart[i + 1]++;
+        sto->strat_colstart[j + 1]++;
+      }
+    }
+  }
+  for(int i = 0; i < sto->strat_nlevels; i++) {
+    sto->strat_rowstart[i + 1] += sto->strat_rowstart[i];
+    sto->strat_colstart[i + 1] += sto->strat_colstart[i];
+  }
+  sto->strat_rowtypes = Calloc(sto->strat_rowstart[sto->strat_nlevels], int);
+  sto->strat_coltypes = Calloc(sto->strat_colstart[sto->strat_nlevels], int);
+  int *colfill = Calloc(sto->strat_nlevels, int);
+  for(int i = 0, k = 0; i < sto->strat_nlevels; i++) {
+    for(int j = 0; j < sto->strat_nlevels; j++) {
+      if(sto->indmat[i][j] >= 0) {
+        sto->strat_rowtypes[k++] = sto->indmat[i][j];
+        sto->strat_coltypes[sto->strat_colstart[j] + colfill[j]++] = sto->indmat[i][j];
+      }
+    }
+  }
+  Free(colfill);
+
   // amat stores toggleability status of blocks mixing types
   int **amat = Calloc(nblockslevels, int *);
   amat[0] = INTEGER(getListElement(MHp->R, "amat"));
@@ -259,7 +289,7 @@ MH_I_FN(Mi_BDStratTNT) {
   // initialize weighted sampling data structure
   sto->wtp = WtPopInitialize(sto->strat_nmixtypes,
                              currentprobvec,
-                             asInteger(getListElement(MHp->R, "dyad_indep")) ? 'W' : 'B');
+                             asInteger(getListElement(MHp->R, "dyad_indep")) ? 'W' : 'D');
   Free(currentprobvec);
 
   // check degree bounds
@@ -285,7 +315,7 @@ MH_P_FN(MH_BDStratTNT) {
   Dyad ndyadstype = BDStratBlocksDyadCount(sto->blocks, sto->stratmixingtype);
 
   int edgestate;
-  if((unif_rand() < 0.5 && nedgestype > 0) || ndyadstype == 0) {
+  if((MH_UNIF_RAND() < 0.5 && nedgestype > 0) || ndyadstype == 0) {
     // propose toggling off a random (toggleable) edge of the sampled strat mixing type
     HashELGetRand(Mtail, Mhead, sto->hash[sto->stratmixingtype]);
     edgestate = TRUE;
@@ -424,6 +454,11 @@ MH_F_FN(Mf_BDStratTNT) {
   }
   Free(sto->indmat);
 
+  Free(sto->strat_rowstart);
+  Free(sto->strat_rowtypes);
+  Free(sto->strat_colstart);
+  Free(sto->strat_coltypes);
+
   Free(sto->original_weights);
 
   Free(sto->strat_mixtypestoupdate);
@@ -453,6 +488,7 @@ MH_F_FN(Mf_BDStratTNT) {
 
 MH_I_FN(Mi_TNT10){
   MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
+  if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
   MHp->ntoggles=10;
 }
 
@@ -468,7 +504,7 @@ MH_P_FN(MH_TNT10){
   BD_LOOP(MH_STORAGE, {
       logratio = 0;
       for(unsigned int n = 0; n < 10; n++){
-	if (unif_rand() < P && nedges > 0) { /* Select a tie at random */
+	if (MH_UNIF_RAND() < P && nedges > 0) { /* Select a tie at random */
 	  GetRandEdge(Mtail, Mhead, nwp);
 	  logratio += TNT_LR_E(nedges, Q, DP, DO);
 	}else{ /* Select a dyad at random */
@@ -502,6 +538,7 @@ MH_F_FN(Mf_TNT10){
 *********************/
 MH_I_FN(Mi_ConstantEdges){
   MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
+  if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
   MHp->ntoggles = 2;
 }
 
@@ -553,7 +590,7 @@ MH_P_FN(MH_CondDegreeDist){
   /* select a node at random */
   while(noutedge+ninedge==0){
     /* select a node at random */
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     ninedge  = nwp->indegree[tail];
     noutedge = nwp->outdegree[tail];
   }
@@ -561,7 +598,7 @@ MH_P_FN(MH_CondDegreeDist){
   /* choose a edge of the node at random */
     /* *** don't forget tail-> head now */
 
-  k0 = (int)(unif_rand() * (noutedge+ninedge)); 
+  k0 = (int)(MH_UNIF_RAND() * (noutedge+ninedge)); 
   if (k0 < noutedge){
     k=0;
     for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -586,7 +623,7 @@ MH_P_FN(MH_CondDegreeDist){
   k1=0;
   fvalid=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     fvalid=1;
     if(alter == head){fvalid=0;}
     if (k0 < noutedge || !DIRECTED){
@@ -684,11 +721,11 @@ MH_P_FN(MH_CondOutDegreeDist){
 
   while(noutedge==0){
     /* select a node at random */
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     noutedge = nwp->outdegree[tail];
   }
   
-  k0 = (int)(unif_rand() * noutedge); 
+  k0 = (int)(MH_UNIF_RAND() * noutedge); 
   k=0;
   for(e = EdgetreeMinimum(nwp->outedges, tail);
       ((head = nwp->outedges[e].value) != 0 && k<k0);
@@ -699,7 +736,7 @@ MH_P_FN(MH_CondOutDegreeDist){
   k1=0;
   fvalid=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     fvalid=1;
     if(alter == head){fvalid=0;}
     for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -757,11 +794,11 @@ MH_P_FN(MH_CondInDegreeDist){
 
   while(ninedge==0){
     /* select a node at random */
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     ninedge = nwp->indegree[tail];
   }
   
-  k0 = (int)(unif_rand() * ninedge); 
+  k0 = (int)(MH_UNIF_RAND() * ninedge); 
   k=0;
   for(e = EdgetreeMinimum(nwp->inedges, tail);
       ((head = nwp->inedges[e].value) != 0 && k<k0);
@@ -772,7 +809,7 @@ MH_P_FN(MH_CondInDegreeDist){
   k1=0;
   fvalid=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     fvalid=1;
     if(alter == head){fvalid=0;}
     for(e = EdgetreeMinimum(nwp->inedges, tail);
@@ -814,8 +851,8 @@ MH_P_FN(MH_TwoRandomToggles){
   }
 
   for (i = 0; i < 2; i++){
-   tail = 1 + unif_rand() * N_NODES;
-   while ((head = 1 + unif_rand() * N_NODES) == tail);
+   tail = 1 + MH_UNIF_RAND() * N_NODES;
+   while ((head = 1 + MH_UNIF_RAND() * N_NODES) == tail);
    if (!DIRECTED && tail > head) {
      Mtail[i] = head;
      Mhead[i] = tail;
@@ -839,7 +876,7 @@ MH_P_FN(MH_randomnode){
     return;
   }
 
-  root = 1 + unif_rand() * N_NODES;
+  root = 1 + MH_UNIF_RAND() * N_NODES;
   
   j = 0;
   for (alter = 1; alter <= N_NODES; alter++)
@@ -858,6 +895,162 @@ MH_P_FN(MH_randomnode){
     }
 }
 
+/*********************
+ void MH_BlockToggles
+
+ Selects a block of up to MH_IINPUTS[0] distinct dyads incident on a
+ random node, independently of the network. If MH_IINPUTS[1] is
+ nonzero, the whole block is proposed with MHp->gibbs set, so that the
+ MCMC sampler can draw its configuration from its full conditional
+ distribution (other samplers will propose toggling all of it);
+ otherwise, a uniformly random nonempty subset of the block is
+ proposed for toggling. Either proposal is symmetric.
+*********************/
+MH_I_FN(Mi_BlockToggles){
+  Vertex nalters = BIPARTITE ? MIN(BIPARTITE, N_NODES - BIPARTITE) : N_NODES - 1;
+  MHp->ntoggles = MIN((Vertex) MH_IINPUTS[0], nalters);
+  if(MHp->ntoggles == 0) MHp->ntoggles = MH_FAILED;
+  MHp->gibbs = MH_IINPUTS[1];
+}
+
+MH_P_FN(Mp_BlockToggles){
+  Vertex nalters = BIPARTITE ? MIN(BIPARTITE, N_NODES - BIPARTITE) : N_NODES - 1;
+  unsigned int k = MIN((Vertex) MH_IINPUTS[0], nalters);
+
+  Vertex root = 1 + MH_UNIF_RAND() * N_NODES;
+  Vertex first = 1, nchoices = N_NODES;
+  if(BIPARTITE){
+    if(root <= BIPARTITE){ first = BIPARTITE + 1; nchoices = N_NODES - BIPARTITE; }
+    else nchoices = BIPARTITE;
+  }
+
+  unsigned int j = 0;
+  while(j < k){
+    Vertex alter = first + MH_UNIF_RAND() * nchoices;
+    if(alter == root) continue;
+
+    Vertex tail = root, head = alter;
+    if(BIPARTITE ? root > BIPARTITE : DIRECTED ? MH_UNIF_RAND() < 0.5 : root > alter){
+      tail = alter;
+      head = root;
+    }
+
+    unsigned int i;
+    for(i = 0; i < j; i++)
+      if(Mtail[i] == tail && Mhead[i] == head) break;
+    if(i < j) continue;
+
+    Mtail[j] = tail;
+    Mhead[j] = head;
+    j++;
+  }
+
+  if(MHp->gibbs){
+    MHp->ntoggles = k;
+    return;
+  }
+
+  /* Keep each dyad with probability 1/2, conditional on keeping one. */
+  do{
+    MHp->ntoggles = 0;
+    for(unsigned int i = 0; i < k; i++){
+      if(MH_UNIF_RAND() < 0.5){
+        Mtail[MHp->ntoggles] = Mtail[i];
+        Mhead[MHp->ntoggles] = Mhead[i];
+        MHp->ntoggles++;
+      }
+    }
+  }while(MHp->ntoggles == 0);
+}
+
+/*********************
+ void MH_NodeSwap
+
+ Proposes exchanging the labels of two distinct random vertices in
+ the same bipartite mode, setting MHp->nodeswap so that the MCMC
+ sampler can let the terms evaluate the move directly. The toggles
+ listed are those dyads incident on exactly one of the two vertices
+ whose state differs from that of their counterpart, plus the two
+ dyads between them if exactly one is an edge. Since the relabeling is
+ its own inverse, the proposal is symmetric.
+*********************/
+MH_I_FN(Mi_NodeSwap){
+  Vertex nb1 = BIPARTITE ? BIPARTITE : N_NODES, nb2 = BIPARTITE ? N_NODES - BIPARTITE : 0;
+  if(nb1 < 2 && nb2 < 2){
+    MHp->ntoggles = MH_FAILED;
+    return;
+  }
+  MHp->ntoggles = (DIRECTED ? 4 : 2) * N_NODES;
+}
+
+MH_P_FN(Mp_NodeSwap){
+  Vertex first = 1, nchoices = N_NODES;
+  Vertex v1 = 1 + MH_UNIF_RAND() * N_NODES;
+  if(BIPARTITE){
+    if(v1 <= BIPARTITE) nchoices = BIPARTITE;
+    else{ first = BIPARTITE + 1; nchoices = N_NODES - BIPARTITE; }
+  }
+  if(nchoices < 2){
+    Mtail[0] = MH_FAILED;
+    Mhead[0] = MH_CONSTRAINT;
+    return;
+  }
+
+  Vertex v2;
+  do v2 = first + MH_UNIF_RAND() * nchoices; while(v2 == v1);
+
+  MHp->ntoggles = 0;
+#define NODESWAP_ADD(t, h) {                                            \
+    Vertex _t = (t);                                                    \
+    Vertex _h = (h);                                                    \
+    if(!DIRECTED && _t > _h){ Vertex _tmp = _t; _t = _h; _h = _tmp; }   \
+    Mtail[MHp->ntoggles] = _t;                                          \
+    Mhead[MHp->ntoggles] = _h;                                          \
+    MHp->ntoggles++;                                                    \
+  }
+#define NODESWAP_OUT(a, b) {                                            \
+    EXEC_THROUGH_OUTEDGES(a, e, u, {                                    \
+        if(u != b && !(DIRECTED ? IS_OUTEDGE(b, u) : IS_UNDIRECTED_EDGE(b, u))){ \
+          NODESWAP_ADD(v1, u);                                          \
+          NODESWAP_ADD(v2, u);                                          \
+        }                                                               \
+      });                                                               \
+  }
+#define NODESWAP_IN(a, b) {                                             \
+    EXEC_THROUGH_FINEDGES(a, e, u, {                                    \
+        if(u != b && !IS_OUTEDGE(u, b)){                                \
+          NODESWAP_ADD(u, v1);                                          \
+          NODESWAP_ADD(u, v2);                                          \
+        }                                                               \
+      });                                                               \
+  }
+
+  NODESWAP_OUT(v1, v2);
+  NODESWAP_OUT(v2, v1);
+  if(DIRECTED){
+    NODESWAP_IN(v1, v2);
+    NODESWAP_IN(v2, v1);
+    if(IS_OUTEDGE(v1, v2) != IS_OUTEDGE(v2, v1)){
+      NODESWAP_ADD(v1, v2);
+      NODESWAP_ADD(v2, v1);
+    }
+  }
+
+#undef NODESWAP_IN
+#undef NODESWAP_OUT
+#undef NODESWAP_ADD
+
+  if(MHp->ntoggles == 0){
+    // The two vertices are structurally equivalent.
+    Mtail[0] = MH_FAILED;
+    Mhead[0] = MH_CONSTRAINT;
+    return;
+  }
+
+  MHp->nodeswap[0] = v1;
+  MHp->nodeswap[1] = v2;
+}
+
 /* The ones below have not been tested */
 
 /*********************
@@ -872,11 +1065,11 @@ MH_P_FN(MH_ConstrainedCondOutDegDist){
 
   while(noutedge==0){
     /* select a node at random */
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     noutedge = nwp->outdegree[tail];
   }
   
-  k0 = (int)(unif_rand() * noutedge); 
+  k0 = (int)(MH_UNIF_RAND() * noutedge); 
   k=0;
   for(e = EdgetreeMinimum(nwp->outedges, tail);
       ((head = nwp->outedges[e].value) != 0 && k<k0);
@@ -887,7 +1080,7 @@ MH_P_FN(MH_ConstrainedCondOutDegDist){
   k1=0;
   fvalid=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     fvalid=1;
     if(alter == head){fvalid=0;}
     for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -934,7 +1127,7 @@ MH_P_FN(MH_NodePairedTiesToggles){
   /* *** don't forget tail-> head now */
   
   /* double to integer coercion */
-  tail = 1 + unif_rand() * N_NODES; 
+  tail = 1 + MH_UNIF_RAND() * N_NODES; 
   
   for(e = EdgetreeMinimum(nwp->outedges, tail);
       (prop = nwp->outedges[e].value) != 0; /* loop if */
@@ -960,7 +1153,7 @@ MH_P_FN(MH_NodePairedTiesToggles){
   j = 0;
   while (j <=nedge)
     {
-      prop = 1 + unif_rand() * N_NODES; 
+      prop = 1 + MH_UNIF_RAND() * N_NODES; 
       k=0;
       fvalid=1;
       while(fvalid==1 && k<nedge+j){
@@ -1016,7 +1209,7 @@ MH_P_FN(MH_OneRandomTnTNode){
   fvalid=0;
   while(fvalid==0){
     
-    if ( unif_rand() < 0.5 && EDGECOUNT(nwp) > 0) 
+    if ( MH_UNIF_RAND() < 0.5 && EDGECOUNT(nwp) > 0) 
       {
 	
 	/* select a tie */
@@ -1024,12 +1217,12 @@ MH_P_FN(MH_OneRandomTnTNode){
 	noutedge=0;
 	while(noutedge+ninedge==0){
 	  /* select a node at random */
-	  tail = 1 + unif_rand() * N_NODES;
+	  tail = 1 + MH_UNIF_RAND() * N_NODES;
 	  ninedge = nwp->indegree[tail];
 	  noutedge = nwp->outdegree[tail];
 	}
 	
-	k0 = (int)(unif_rand() * (noutedge+ninedge)); 
+	k0 = (int)(MH_UNIF_RAND() * (noutedge+ninedge)); 
 	if (k0 < noutedge){
 	  k=0;
 	  for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -1062,14 +1255,14 @@ MH_P_FN(MH_OneRandomTnTNode){
 	while(noutedge+ninedge>=(N_NODES-1)){
 	  ninedge=0;
 	  /* select a node at random */
-	  tail = 1 + unif_rand() * N_NODES;
+	  tail = 1 + MH_UNIF_RAND() * N_NODES;
 	  ninedge = nwp->indegree[tail];
 	  noutedge = nwp->outdegree[tail];
 	}
 	
 	fvalid=0;
 	while(fvalid==0){
-	  while ((head = 1 + unif_rand() * N_NODES) == tail);
+	  while ((head = 1 + MH_UNIF_RAND() * N_NODES) == tail);
 	  fvalid=1;
 	  for(e = EdgetreeMinimum(nwp->outedges, tail);
 	      (fvalid==1 && ((head1 = nwp->outedges[e].value) != 0));
@@ -1114,7 +1307,7 @@ MH_P_FN(MH_ReallocateWithReplacement){
   int edgecount = 0;
   
   /* select a node at random */
-  root = 1 + unif_rand() * N_NODES;
+  root = 1 + MH_UNIF_RAND() * N_NODES;
 
   edges = (Vertex *) Calloc(N_NODES+1, Vertex);
   for (i = 0; i <= N_NODES; i++)
@@ -1142,7 +1335,7 @@ MH_P_FN(MH_ReallocateWithReplacement){
     {
       Vertex newhead;
       /* get a new edge, neither the root nor something already chosen */
-      while ((newhead = 1 + unif_rand() * N_NODES) == root ||
+      while ((newhead = 1 + MH_UNIF_RAND() * N_NODES) == root ||
 	     (edges[newhead] & NEW_EDGE))
 	;
       
@@ -1184,7 +1377,7 @@ MH_P_FN(MH_AllTogglesForOneNode){
   int j;
   int root;
   
-  root = 1 + unif_rand() * N_NODES;
+  root = 1 + MH_UNIF_RAND() * N_NODES;
   
   j = 0;
   for (i = 1; i <= N_NODES; i++)
@@ -1226,7 +1419,7 @@ MH_P_FN(MH_SwitchLabelTwoNodesToggles){
   edges2 = (Vertex *) Calloc(N_NODES+1, Vertex);
   
   while(nedge1==0){
-    tail1 = 1 + unif_rand() * N_NODES;
+    tail1 = 1 + MH_UNIF_RAND() * N_NODES;
     
     for(e = EdgetreeMinimum(nwp->outedges, tail1);
 	(head1 = nwp->outedges[e].value) != 0; /* loop if */
@@ -1244,7 +1437,7 @@ MH_P_FN(MH_SwitchLabelTwoNodesToggles){
       }
   }
   
-  while((tail2 = 1 + unif_rand() * N_NODES) == tail1);
+  while((tail2 = 1 + MH_UNIF_RAND() * N_NODES) == tail1);
   
   for(e = EdgetreeMinimum(nwp->outedges, tail2);
       (head2 = nwp->outedges[e].value) != 0; /* loop if */
@@ -1335,7 +1528,7 @@ MH_P_FN(MH_ConstrainedCondDegDist){
   inedges = (Vertex *) Calloc(N_NODES+1, Vertex);
   
   while(noutedge==0 && ninedge==0){
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     
     for(e = EdgetreeMinimum(nwp->outedges, tail);
 	(head = nwp->outedges[e].value) != 0; /* loop if */
@@ -1353,7 +1546,7 @@ MH_P_FN(MH_ConstrainedCondDegDist){
       }
   }
   
-  k0 = (int)(unif_rand() * (noutedge+ninedge)); 
+  k0 = (int)(MH_UNIF_RAND() * (noutedge+ninedge)); 
   if (k0 < noutedge){
     head = outedges[k0]; 
   }else{
@@ -1377,7 +1570,7 @@ MH_P_FN(MH_ConstrainedCondDegDist){
   fvalid=0;
   k1=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     if(alter != head){fvalid=1;}
     fvalid=1;
     if (k0 < noutedge || !(DIRECTED)){
@@ -1479,7 +1672,7 @@ void MH_ConstrainedNodePairedTiesToggles (MHProposal *MHp,
   /* *** don't forget tail-> head now */
   
   /* double to integer coercion */
-  tail = 1 + unif_rand() * N_NODES; 
+  tail = 1 + MH_UNIF_RAND() * N_NODES; 
   
   for(e = EdgetreeMinimum(nwp->outedges, tail);
       (prop = nwp->outedges[e].value) != 0; /* loop if */
@@ -1505,7 +1698,7 @@ void MH_ConstrainedNodePairedTiesToggles (MHProposal *MHp,
   j = 0;
   while (j <=nedge)
     {
-      prop = 1 + unif_rand() * N_NODES; 
+      prop = 1 + MH_UNIF_RAND() * N_NODES; 
       k=0;
       fvalid=1;
       while(fvalid==1 && k<nedge+j){
@@ -1550,7 +1743,7 @@ void MH_ConstrainedReallocateWithReplacement (MHProposal *MHp,
   int edgecount = 0;
   
   /* select a node at random */
-  root = 1 + unif_rand() * N_NODES;
+  root = 1 + MH_UNIF_RAND() * N_NODES;
 
   edges = (Vertex *) Calloc(N_NODES+1, Vertex);
   for (i = 0; i <= N_NODES; i++)
@@ -1579,7 +1772,7 @@ void MH_ConstrainedReallocateWithReplacement (MHProposal *MHp,
       Vertex newhead;
       
       /* get a new edge, neither the root nor something already chosen */
-      while ((newhead = 1 + unif_rand() * N_NODES) == root ||
+      while ((newhead = 1 + MH_UNIF_RAND() * N_NODES) == root ||
 	     (edges[newhead] & NEW_EDGE))
 	;
       
@@ -1621,7 +1814,7 @@ void MH_ConstrainedAllTogglesForOneNode (MHProposal *MHp,
   int j;
   int root;
   
-  root = 1 + unif_rand() * N_NODES;
+  root = 1 + MH_UNIF_RAND() * N_NODES;
   
   j = 0;
   for (i = 1; i <= N_NODES; i++)
@@ -1662,12 +1855,12 @@ void MH_ConstrainedTwoRandomToggles (MHProposal *MHp,
   for (i = 0; i < 2; i++)
     {
       /* double to integer coercion */
-      Mtail[i] = 1 + unif_rand() * N_NODES; 
-      while ((Mhead[i] = 1 + unif_rand() * N_NODES) == Mtail[i]);
+      Mtail[i] = 1 + MH_UNIF_RAND() * N_NODES; 
+      while ((Mhead[i] = 1 + MH_UNIF_RAND() * N_NODES) == Mtail[i]);
       
       while(dEdgeListSearch(Mtail[i], Mhead[i], MH_INPUTS)==0){
-	Mtail[i] = 1 + unif_rand() * N_NODES; 
-	while ((Mhead[i] = 1 + unif_rand() * N_NODES) == Mtail[i]);
+	Mtail[i] = 1 + MH_UNIF_RAND() * N_NODES; 
+	while ((Mhead[i] = 1 + MH_UNIF_RAND() * N_NODES) == Mtail[i]);
       }
       if (!DIRECTED && Mtail[i] > Mhead[i]) 
 	{
@@ -1705,7 +1898,7 @@ void MH_ConstrainedCondDeg (MHProposal *MHp,
   edges2 = (Vertex *) Calloc(N_NODES+1, Vertex);
   
   while(nedge1==0){
-    tail1 = 1 + unif_rand() * N_NODES;
+    tail1 = 1 + MH_UNIF_RAND() * N_NODES;
     
     for(e = EdgetreeMinimum(nwp->outedges, tail1);
 	(head1 = nwp->outedges[e].value) != 0; /* loop if */
@@ -1723,7 +1916,7 @@ void MH_ConstrainedCondDeg (MHProposal *MHp,
       }
   }
   
-  head1 = edges1[(int)(unif_rand() * nedge1)]; 
+  head1 = edges1[(int)(MH_UNIF_RAND() * nedge1)]; 
   if (tail1 > head1)
     {
       Mtail[0] = head1;
@@ -1737,7 +1930,7 @@ void MH_ConstrainedCondDeg (MHProposal *MHp,
   while(nedge2==0 && toomany < 100){
     fvalid=0;
     while(fvalid==0){
-      while((tail2 = 1 + unif_rand() * N_NODES) == tail1);
+      while((tail2 = 1 + MH_UNIF_RAND() * N_NODES) == tail1);
       k=0;
       fvalid=1;
       while(fvalid==1 && k < nedge1){
@@ -1768,7 +1961,7 @@ void MH_ConstrainedCondDeg (MHProposal *MHp,
   toomany=0;
   fvalid=0;
   while(fvalid==0 && toomany < 10){
-    while((head2 = edges2[(int)(unif_rand() * nedge2)]) == tail1);
+    while((head2 = edges2[(int)(MH_UNIF_RAND() * nedge2)]) == tail1);
     k=0;
     fvalid=1;
     while(fvalid==1 && k < nedge1){
@@ -1811,7 +2004,7 @@ void MH_ConstrainedSwitchLabelTwoNodesToggles (MHProposal *MHp,
   edges2 = (Vertex *) Calloc(N_NODES+1, Vertex);
 
   while(nedge1==0){
-    tail1 = 1 + unif_rand() * N_NODES;
+    tail1 = 1 + MH_UNIF_RAND() * N_NODES;
     
     for(e = EdgetreeMinimum(nwp->outedges, tail1);
 	(head1 = nwp->outedges[e].value) != 0; /* loop if */
@@ -1829,7 +2022,7 @@ void MH_ConstrainedSwitchLabelTwoNodesToggles (MHProposal *MHp,
       }
   }
   
-  while((tail2 = 1 + unif_rand() * N_NODES) == tail1);
+  while((tail2 = 1 + MH_UNIF_RAND() * N_NODES) == tail1);
   
   for(e = EdgetreeMinimum(nwp->outedges, tail2);
       (head2 = nwp->outedges[e].value) != 0; /* loop if */
@@ -1914,12 +2107,12 @@ MH_P_FN(MH_ConstantEdgesToggles){
   
   while(noutedge+ninedge==0){
     /* select a node at random */
-    tail = 1 + unif_rand() * N_NODES;
+    tail = 1 + MH_UNIF_RAND() * N_NODES;
     ninedge  = nwp->indegree[tail];
     noutedge = nwp->outdegree[tail];
   }
   
-  k0 = (int)(unif_rand() * (noutedge+ninedge)); 
+  k0 = (int)(MH_UNIF_RAND() * (noutedge+ninedge)); 
   if (k0 < noutedge){
     k=0;
     for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -1945,7 +2138,7 @@ MH_P_FN(MH_ConstantEdgesToggles){
   k1=0;
   fvalid=0;
   while(fvalid==0 && k1 < 100){
-    while((alter = 1 + unif_rand() * N_NODES) == tail);
+    while((alter = 1 + MH_UNIF_RAND() * N_NODES) == tail);
     fvalid=1;
     if(alter == head){fvalid=0;}
     if (k0 < noutedge || !(DIRECTED)){
@@ -2000,12 +2193,12 @@ MH_P_FN(MH_CondDegSwitchToggles){
     noutedge=0;
     ninedge=0;
     while(noutedge==0 && ninedge==0 && toomany < 100){
-      tail = 1 + unif_rand() * N_NODES;
+      tail = 1 + MH_UNIF_RAND() * N_NODES;
       ninedge=0;
       noutedge=0;
       while(noutedge+ninedge==0){
 	/* select a node at random */
-	tail = 1 + unif_rand() * N_NODES;
+	tail = 1 + MH_UNIF_RAND() * N_NODES;
 	ninedge = nwp->indegree[tail];
 	noutedge = nwp->outdegree[tail];
       }
@@ -2017,7 +2210,7 @@ MH_P_FN(MH_CondDegSwitchToggles){
       Mtail[1] = Mhead[1] = 0;
     }
     
-    k0 = (int)(unif_rand() * (noutedge+ninedge)); 
+    k0 = (int)(MH_UNIF_RAND() * (noutedge+ninedge)); 
     if (k0 < noutedge){
       k=0;
       for(e = EdgetreeMinimum(nwp->outedges, tail);
@@ -38,7 +38,7 @@ MH_P_FN(MH_BipartiteHammingConstantEdges)
     return;
   }
   
-  if (unif_rand() < comp && nddyads > 0) { /* Select a discordant pair of tie/nontie at random */
+  if (MH_UNIF_RAND() < comp && nddyads > 0) { /* Select a discordant pair of tie/nontie at random */
     /* First, select discord edge at random */
     do{
       GetRandEdge(Mtail, Mhead, &nwp[1]);
@@ -75,8 +75,8 @@ MH_P_FN(MH_BipartiteHammingConstantEdges)
        
     /* Next, select concord non-edge at random */
     do{
-      tail = 1 + unif_rand() * nb1;
-      head = 1 + nb1 + unif_rand() * (nnodes - nb1);
+      tail = 1 + MH_UNIF_RAND() * nb1;
+      head = 1 + nb1 + MH_UNIF_RAND() * (nnodes - nb1);
     }while((EdgetreeSearch(tail,head,nwp[0].outedges)!=0) ||
 	     (EdgetreeSearch(tail,head,nwp[1].outedges)!=0));
 
@@ -130,7 +130,7 @@ MH_P_FN(MH_BipartiteHammingTNT)
     return;
   }
   
-  if (unif_rand() < comp && nddyads > 0) { /* Select a discordant dyad at random */
+  if (MH_UNIF_RAND() < comp && nddyads > 0) { /* Select a discordant dyad at random */
     GetRandEdge(Mtail, Mhead, &nwp[1]);
     nd = nddyads;
     nc = ndyads-nd;
@@ -144,8 +144,8 @@ MH_P_FN(MH_BipartiteHammingTNT)
   }else{
     /* select a concordant dyad at random */
     do{
-      tail = 1 + unif_rand() * nb1;
-      head = 1 + nb1 + unif_rand() * (nnodes - nb1);
+      tail = 1 + MH_UNIF_RAND() * nb1;
+      head = 1 + nb1 + MH_UNIF_RAND() * (nnodes - nb1);
     }while(EdgetreeSearch(tail,head,nwp[1].outedges)!=0);
 
     Mtail[0]=tail;
@@ -196,18 +196,18 @@ MH_P_FN(MH_BipartiteCondDegreeDist){
     tailin = tailout = 0;  
     /* choose a node at random; ensure it has some edges */
     while (tailin + tailout == 0) {
-      u = unif_rand();
+      u = MH_UNIF_RAND();
       if (u < .5) { /* Pick "male" and "female" nodes with equal prob */
-        tail = 1 + unif_rand() * nwp->bipartite;
+        tail = 1 + MH_UNIF_RAND() * nwp->bipartite;
       } else {
-        tail = 1 + nwp->bipartite + unif_rand() * (nwp->nnodes - nwp->bipartite);
+        tail = 1 + nwp->bipartite + MH_UNIF_RAND() * (nwp->nnodes - nwp->bipartite);
       }
       tailin = nwp->indegree[tail];
       tailout = nwp->outdegree[tail];
     }
     
     /* select an edge to/from tail at random */
-    k = (int)(unif_rand() * (tailout + tailin));  
+    k = (int)(MH_UNIF_RAND() * (tailout + tailin));  
     if (k < tailout) { /* we chose an outedge */
       tail_edges = nwp->outedges;
       i = k;
@@ -242,7 +242,7 @@ MH_P_FN(MH_BipartiteCondDegreeDist){
     } /* After for-loop, i is # of eligible alters.  */
     if (i>0) {
       valid = 1;
-      i = 1 + unif_rand()*i; /* Pick an eligible alter at random */
+      i = 1 + MH_UNIF_RAND()*i; /* Pick an eligible alter at random */
       for (A=minA; i>0; A++) {
         Adeg = nwp->directed_flag ? headA_degrees[A] : nwp->indegree[A] + nwp->outdegree[A];
         /* To be a valid choice, alter (A) must not be tied to tail and it must have */
@@ -7,52 +7,170 @@
  *
  *  Copyright 2003-2022 Statnet Commons
  */
+#define STRICT_MH_HEADERS
 #include "ergm_MHproposal.h"
+#include "ergm_MHstorage.h"
 #include "ergm_changestat.h"
+#include "changestats_attrnbr.h"
+
+/* Helpers for the degree-preserving proposals below.
+
+   Since these proposals never change any degree, the number of
+   neighbors and non-neighbors of each vertex is fixed for the
+   duration of the sampling, so valid configurations can be sampled
+   directly rather than by rejection, and the proposal probabilities
+   of a move and its reverse can be computed exactly. The
+   neighbor-list auxiliary (see R/InitErgmTerm.attrnbr.R), if
+   requested by the proposal, is used to select the kth neighbor of a
+   vertex in constant time. */
+
+/* The degree of v: the in-degree if in, the out-degree otherwise; for
+   undirected networks, the degree. */
+static inline Vertex CondDegreeDeg(Vertex v, Rboolean in, Network *nwp){
+  return DIRECTED ? (in ? IN_DEG[v] : OUT_DEG[v]) : OUT_DEG[v] + IN_DEG[v];
+}
+
+/* The number of vertices in first..last that v could gain as a new
+   in-neighbor (if in) or out-neighbor (otherwise). */
+static inline Vertex CondDegreeNonNbrCount(Vertex v, Vertex first, Vertex last, Rboolean in, Network *nwp){
+  return last - first + 1 - CondDegreeDeg(v, in, nwp) - (v >= first && v <= last);
+}
+
+/* The proposal's neighbor-list auxiliary, if one was requested. */
+static inline StoreAttrNbr *CondDegreeAux(MHProposal *MHp){
+  StoreAttrNbr *an = MH_N_AUX ? MH_AUX_STORAGE_NUM(0) : NULL;
+  return an && an->outlist ? an : NULL;
+}
+
+/* The kth (counting from 0) in-neighbor (if in) or out-neighbor
+   (otherwise) of v. */
+static inline Vertex CondDegreeNbr(Vertex v, Vertex k, Rboolean in, StoreAttrNbr *an, Network *nwp){
+  if(an) return in ? ATTRNBR_INLIST(an, v, 1)[k] : ATTRNBR_OUTLIST(an, v, 1)[k];
+
+  Edge e;
+  Vertex u;
+  if(!DIRECTED || in) STEP_THROUGH_INEDGES(v, e, u) if(k-- == 0) return u;
+  if(!DIRECTED || !in) STEP_THROUGH_OUTEDGES(v, e, u) if(k-- == 0) return u;
+  return 0; // Not reached.
+}
+
+/* A vertex selected uniformly at random among those counted by
+   CondDegreeNonNbrCount(), which must not be 0.
+
+   If at least half of the range qualifies, simply draw from the range
+   until a qualifying vertex comes up, which takes fewer than two
+   draws on average; otherwise, draw an index among the qualifying
+   vertices and step over the disqualified ones, which are visited in
+   increasing order. */
+static inline Vertex CondDegreeNonNbr(Vertex v, Vertex first, Vertex last, Rboolean in, MHProposal *MHp, Network *nwp){
+  Vertex size = last - first + 1, nn = CondDegreeNonNbrCount(v, first, last, in, nwp);
+  Vertex u;
+
+  if(nn*2 >= size){
+    do{
+      u = first + MH_UNIF_RAND() * size;
+    }while(u == v ||
+           (DIRECTED ?
+            (in ? IS_OUTEDGE(u, v) : IS_OUTEDGE(v, u)) : // Directed
+            IS_UNDIRECTED_EDGE(u, v) // Undirected
+            ));
+    return u;
+  }
+
+  u = first + MH_UNIF_RAND() * nn;
+  Rboolean vpending = v >= first && v <= last;
+  Edge e;
+  Vertex x;
+  // For undirected networks, all tails in v's in-tree precede v, which
+  // precedes all heads in its out-tree.
+  if(!DIRECTED || in) STEP_THROUGH_INEDGES(v, e, x){
+      if(vpending && v < x){
+        if(v <= u) u++; else return u;
+        vpending = FALSE;
+      }
+      if(x <= u) u++; else return u;
+    }
+  if(!DIRECTED || !in) STEP_THROUGH_OUTEDGES(v, e, x){
+      if(vpending && v < x){
+        if(v <= u) u++; else return u;
+        vpending = FALSE;
+      }
+      if(x <= u) u++; else return u;
+    }
+  if(vpending && v <= u) u++;
+  return u;
+}
+
+#define CONDDEGREE_NULL_MOVE {Mtail[0]=MH_FAILED; Mhead[0]=MH_CONSTRAINT; return;}
 
 /* 
 void MH_CondDegreeTetrad
 
    Select two edges with no nodes in common, A1-A2 and B1-B2, s.t. A1-B2 and B1-A2 are not edges, and propose to replace the former two by the latter two.
+
+   A1-A2 is a random edge, B2 a random vertex that A1 could gain as an
+   (out-)neighbor, and B1 a random (in-)neighbor of B2; if B1-A2
+   cannot be added, the proposal is a null move. The same move is
+   also generated from B1-B2 (and, for undirected unipartite networks,
+   from either edge traversed in the opposite direction), so the
+   probabilities of all of these are summed to get that of the move
+   and of its reverse.
  */
+/* The probability, up to a constant, of proposing P1->P2 as the
+   first edge and then Q2 as the new head for P1. */
+#define TETRAD_W(P1, Q2) (1.0/((double)CondDegreeNonNbrCount(P1, first, N_NODES, FALSE, nwp)*CondDegreeDeg(Q2, TRUE, nwp)))
+
 MH_P_FN(MH_CondDegreeTetrad){  
   Vertex A1, A2, B1, B2;
   
   if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=4;    
+    MHp->ntoggles = N_EDGES ? 4 : MH_FAILED;
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 
-//nstats = N_CHANGE_STATS;
-//matchvaltail = INPUT_PARAM[tail-1+2*nstats];
-//matchvalhead = INPUT_PARAM[head-1+2*nstats];
-  do{
-    /*
-      The reason the following randomization is needed is that, given
-      the a tetrad with (only) A1-A2 and B1-B2 having edges, there are
-      two degree-preserving proposals that can be made: to replace the
-      edges with A1-B2 and B1-A2 or to replace with A1-B1 and A2-B2.
+  StoreAttrNbr *an = CondDegreeAux(MHp);
+  Vertex first = BIPARTITE ? BIPARTITE+1 : 1;
+
+  /*
+    The reason the following randomization is needed is that, given
+    the a tetrad with (only) A1-A2 and B1-B2 having edges, there are
+    two degree-preserving proposals that can be made: to replace the
+    edges with A1-B2 and B1-A2 or to replace with A1-B1 and A2-B2.
       
-      GetRandEdge always returns tail<head for undirected networks, so
-      a sampler that only uses GetRandEdge(&A1, &A2, nwp) misses out
-      on potential proposals. This causes it to become trapped in
-      bipartite or near-bipartite configurations. Bipartite networks
-      are already bipartite, so they are not affected.
-
-      Swapping A1 and A2 half the time allows either of the above
-      proposals to be considered.
-    */
-    if(!DIRECTED && !BIPARTITE && unif_rand()<0.5) GetRandEdge(&A2, &A1, nwp);
-    else GetRandEdge(&A1, &A2, nwp);
+    GetRandEdge always returns tail<head for undirected networks, so
+    a sampler that only uses GetRandEdge(&A1, &A2, nwp) misses out
+    on potential proposals. This causes it to become trapped in
+    bipartite or near-bipartite configurations. Bipartite networks
+    are already bipartite, so they are not affected.
+
+    Swapping A1 and A2 half the time allows either of the above
+    proposals to be considered.
+  */
+  if(!DIRECTED && !BIPARTITE && MH_UNIF_RAND()<0.5) GetRandEdge(&A2, &A1, nwp);
+  else GetRandEdge(&A1, &A2, nwp);
+
+  if(CondDegreeNonNbrCount(A1, first, N_NODES, FALSE, nwp) == 0) CONDDEGREE_NULL_MOVE;
+  B2 = CondDegreeNonNbr(A1, first, N_NODES, FALSE, MHp, nwp);
+
+  Vertex d = CondDegreeDeg(B2, TRUE, nwp);
+  if(d == 0) CONDDEGREE_NULL_MOVE;
+  B1 = CondDegreeNbr(B2, MH_UNIF_RAND() * d, TRUE, an, nwp);
+
+  if(A2==B1 ||
+     (DIRECTED ? 
+      IS_OUTEDGE(B1, A2) : // Directed
+      IS_UNDIRECTED_EDGE(B1,A2) // Undirected
+      )) CONDDEGREE_NULL_MOVE;
+
+  double fwd = TETRAD_W(A1, B2) + TETRAD_W(B1, A2),
+    bwd = TETRAD_W(A1, A2) + TETRAD_W(B1, B2);
+  if(!DIRECTED && !BIPARTITE){
+    fwd += TETRAD_W(A2, B1) + TETRAD_W(B2, A1);
+    bwd += TETRAD_W(A2, A1) + TETRAD_W(B2, B1);
+  }
+  MHp->logratio += log(bwd/fwd);
 
-    GetRandEdge(&B1, &B2, nwp);
-    //Rprintf("A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-  }while(A1==B1 || A1==B2 || A2==B1 || A2==B2 || 
-	 (DIRECTED ? 
-	  (IS_OUTEDGE(A1, B2) || IS_OUTEDGE(B1, A2)) : // Directed
-	  (IS_UNDIRECTED_EDGE(A1,B2) || IS_UNDIRECTED_EDGE(B1,A2)) // Undirected
-	  ));
-  //Rprintf("in A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
   if(DIRECTED){
     Mtail[0]=A1; Mhead[0]=A2;
     Mtail[1]=A1; Mhead[1]=B2;
@@ -66,6 +184,8 @@ MH_P_FN(MH_CondDegreeTetrad){
   }
 }
 
+#undef TETRAD_W
+
 //MH_P_FN(MH_CondDegreeMix){  
 //  
 //  if(MHp->ntoggles == 0) { /* Initialize CondDeg by */
@@ -91,6 +211,7 @@ MH_P_FN(MH_CondDegreeTetradMixMore){
   
   if(MHp->ntoggles == 0) { /* Initialize */
     MHp->ntoggles=4;    
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 //  Rprintf("0 %f 1 %f 2 %f 3 %f\n",MHp->inputs[0],MHp->inputs[1],MHp->inputs[2],MHp->inputs[3]); 
@@ -127,6 +248,7 @@ MH_P_FN(MH_CondDegreeTetradMixLess){
   
   if(MHp->ntoggles == 0) { /* Initialize */
     MHp->ntoggles=4;    
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 //  Rprintf("0 %f 1 %f 2 %f 3 %f\n",MHp->inputs[0],MHp->inputs[1],MHp->inputs[2],MHp->inputs[3]); 
@@ -162,6 +284,7 @@ MH_P_FN(MH_CondDegreeMixChangeOrig){
   
   if(MHp->ntoggles == 0) { /* Initialize */
     MHp->ntoggles=4;    
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 //  Rprintf("0 %f 1 %f 2 %f 3 %f\n",MHp->inputs[0],MHp->inputs[1],MHp->inputs[2],MHp->inputs[3]); 
@@ -171,7 +294,7 @@ MH_P_FN(MH_CondDegreeMixChangeOrig){
   do{
     GetRandEdge(&A1, &A2, nwp);
     GetRandEdge(&B1, &B2, nwp);
-    bb=(unif_rand() > 0.05);
+    bb=(MH_UNIF_RAND() > 0.05);
     bbb++;
     if(bb){
 //  if(unif_rand() > 0.5){
@@ -215,11 +338,12 @@ MH_P_FN(MH_CondDegreeMix){
   
   if(MHp->ntoggles == 0) { /* Initialize */
     MHp->ntoggles=8;    
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 
   numtrys=0;
-  pm=(unif_rand() > 0.5);
+  pm=(MH_UNIF_RAND() > 0.5);
   if(pm){
   do{
     GetRandEdge(&A11, &A12, nwp);
@@ -311,26 +435,50 @@ void MH_CondDegreeHexad
    C1=B2. Indeed, "reversing" the cyclical triangle is the one
    operation that tetradic toggles can't accomplish.
 
+   A1->A2 is a random edge, B2 a random non-out-neighbor of A1, B1 a
+   random in-neighbor of B2, C2 a random non-out-neighbor of B1, and
+   C1 a random in-neighbor of C2; if the resulting configuration is
+   not valid, the proposal is a null move. Each of the three rotations
+   of the move is generated in this manner, so their probabilities
+   are summed to get that of the move and of its reverse.
+
    Note that this must *never* be called for undirected networks.
 
  */
+/* The probability, up to a constant, of proposing P1->P2 as the
+   first edge, Q2 as the new head for P1, and R2 as the new head for
+   Q2's selected in-neighbor Q1. */
+#define HEXAD_W(P1, Q2, Q1, R2) (1.0/((double)CondDegreeNonNbrCount(P1, 1, N_NODES, FALSE, nwp)*CondDegreeDeg(Q2, TRUE, nwp)* \
+                                      (double)CondDegreeNonNbrCount(Q1, 1, N_NODES, FALSE, nwp)*CondDegreeDeg(R2, TRUE, nwp)))
+
 MH_P_FN(MH_CondDegreeHexad){  
-  Vertex A1, A2, B1, B2, C1, C2;
+  Vertex A1, A2, B1, B2, C1, C2, d;
   
   if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=6;
+    MHp->ntoggles = N_EDGES ? 6 : MH_FAILED;
+    if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 
+  StoreAttrNbr *an = CondDegreeAux(MHp);
+
   GetRandEdge(&A1, &A2, nwp);
 
-  do{
-    GetRandEdge(&B1, &B2, nwp);
-  }while(B1==A1 || B2==A1 || B2==A2 || IS_OUTEDGE(A1, B2));
+  if(CondDegreeNonNbrCount(A1, 1, N_NODES, FALSE, nwp) == 0) CONDDEGREE_NULL_MOVE;
+  B2 = CondDegreeNonNbr(A1, 1, N_NODES, FALSE, MHp, nwp);
+  if((d = IN_DEG[B2]) == 0) CONDDEGREE_NULL_MOVE;
+  B1 = CondDegreeNbr(B2, MH_UNIF_RAND() * d, TRUE, an, nwp);
 
-  do{
-    GetRandEdge(&C1, &C2, nwp);
-  }while(C1==A1 || C1==B1 || C1==A2 || C2==A2 || C2==B2 || C2==B1 || IS_OUTEDGE(B1, C2) || IS_OUTEDGE(C1, A2));
+  if(CondDegreeNonNbrCount(B1, 1, N_NODES, FALSE, nwp) == 0) CONDDEGREE_NULL_MOVE;
+  C2 = CondDegreeNonNbr(B1, 1, N_NODES, FALSE, MHp, nwp);
+  if((d = IN_DEG[C2]) == 0) CONDDEGREE_NULL_MOVE;
+  C1 = CondDegreeNbr(C2, MH_UNIF_RAND() * d, TRUE, an, nwp);
+
+  if(C1==A1 || C1==A2 || C2==A2 || IS_OUTEDGE(C1, A2)) CONDDEGREE_NULL_MOVE;
+
+  double fwd = HEXAD_W(A1, B2, B1, C2) + HEXAD_W(B1, C2, C1, A2) + HEXAD_W(C1, A2, A1, B2),
+    bwd = HEXAD_W(A1, A2, C1, C2) + HEXAD_W(C1, C2, B1, B2) + HEXAD_W(B1, B2, A1, A2);
+  MHp->logratio += log(bwd/fwd);
 
   Mtail[0]=A1; Mhead[0]=A2;
   Mtail[1]=A1; Mhead[1]=B2;
@@ -340,14 +488,17 @@ MH_P_FN(MH_CondDegreeHexad){
   Mtail[5]=C1; Mhead[5]=A2;
 }
 
+#undef HEXAD_W
+
 MH_P_FN(MH_CondDegree){  
   
   if(MHp->ntoggles == 0) { /* Initialize CondDeg by */
-      MHp->ntoggles= DIRECTED ? 6 : 4;
+      MHp->ntoggles = N_EDGES ? (DIRECTED ? 6 : 4) : MH_FAILED;
+      if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
     return;
   }
 
-  if(DIRECTED && unif_rand() > 0.9){ /* Do the tetrad or hexad proposal. Undirected networks don't need the hexad.*/
+  if(DIRECTED && MH_UNIF_RAND() > 0.9){ /* Do the tetrad or hexad proposal. Undirected networks don't need the hexad.*/
     MHp->ntoggles=6;
     MH_CondDegreeHexad(MHp, nwp);
   }else{
@@ -356,79 +507,78 @@ MH_P_FN(MH_CondDegree){
   }
 }
 
-MH_P_FN(MH_CondOutDegree){  
-  Vertex A1, A2, B2;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=2;
-    return;
+/* The proposals below hold the degrees on one side of each edge fixed
+   by moving the other end of an edge from one vertex to another.
+
+   The pivot (the vertex whose degree the move keeps) is selected with
+   probability proportional to its degree among those that have
+   somewhere to move an edge to, and then one of its edges uniformly;
+   since the degrees do not change, the cumulative weights are
+   computed once, at initialization, and kept in the proposal storage
+   (an array of Edge of length N_NODES+1). The new endpoint is
+   selected uniformly among the eligible vertices in first..last, so
+   the proposal is symmetric. */
+static void CondDegreeSwapInit(MHProposal *MHp, Network *nwp, Vertex pfirst, Vertex plast, Vertex first, Vertex last, Rboolean in){
+  MH_ALLOC_STORAGE(N_NODES+1, Edge, cum);
+  for(Vertex v=1; v<=N_NODES; v++)
+    cum[v] = cum[v-1] + (v >= pfirst && v <= plast && CondDegreeNonNbrCount(v, first, last, in, nwp) ? CondDegreeDeg(v, in, nwp) : 0);
+
+  MHp->ntoggles = cum[N_NODES] ? 2 : MH_FAILED;
+}
+
+static void CondDegreeSwap(MHProposal *MHp, Network *nwp, Vertex first, Vertex last, Rboolean in){
+  MH_GET_STORAGE(Edge, cum);
+  Edge r = MH_UNIF_RAND() * cum[N_NODES];
+
+  // Find the pivot v s.t. cum[v-1] <= r < cum[v].
+  Vertex lo = 1, hi = N_NODES;
+  while(lo < hi){
+    Vertex mid = lo + (hi-lo)/2;
+    if(cum[mid] > r) hi = mid;
+    else lo = mid+1;
   }
+  Vertex v = lo;
 
-  do{
-    GetRandEdge(&A1, &A2, nwp);
-    B2 = 1 + unif_rand() * N_NODES;
-  }while(A1==B2 || A2==B2 || IS_OUTEDGE(A1, B2));
+  Vertex A = CondDegreeNbr(v, r - cum[v-1], in, CondDegreeAux(MHp), nwp);
+  Vertex B = CondDegreeNonNbr(v, first, last, in, MHp, nwp);
 
-//Rprintf("A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-//Rprintf("in A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-  Mtail[0]=A1; Mhead[0]=A2;
-  Mtail[1]=A1; Mhead[1]=B2;
+  if(in){
+    Mtail[0]=A; Mhead[0]=v;
+    Mtail[1]=B; Mhead[1]=v;
+  }else{
+    Mtail[0]=v; Mhead[0]=A;
+    Mtail[1]=v; Mhead[1]=B;
+  }
 }
 
-MH_P_FN(MH_CondInDegree){  
-  Vertex A1, A2, B1;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=2;
-    return;
-  }
+MH_I_FN(Mi_CondOutDegree){
+  CondDegreeSwapInit(MHp, nwp, 1, N_NODES, 1, N_NODES, FALSE);
+}
 
-  do{
-    GetRandEdge(&A1, &A2, nwp);
-    B1 = 1 + unif_rand() * N_NODES;
-  }while(A1==B1 || A2==B1 || IS_OUTEDGE(B1, A2));
+MH_P_FN(MH_CondOutDegree){  
+  CondDegreeSwap(MHp, nwp, 1, N_NODES, FALSE);
+}
 
-//Rprintf("A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-//Rprintf("in A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-  Mtail[0]=A1; Mhead[0]=A2;
-  Mtail[1]=B1; Mhead[1]=A2;
+MH_I_FN(Mi_CondInDegree){
+  CondDegreeSwapInit(MHp, nwp, 1, N_NODES, 1, N_NODES, TRUE);
 }
 
+MH_P_FN(MH_CondInDegree){  
+  CondDegreeSwap(MHp, nwp, 1, N_NODES, TRUE);
+}
 
-MH_P_FN(MH_CondB1Degree){  
-  Vertex A1, A2, B2;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=2;
-    return;
-  }
+MH_I_FN(Mi_CondB1Degree){
+  CondDegreeSwapInit(MHp, nwp, 1, BIPARTITE, BIPARTITE+1, N_NODES, FALSE);
+}
 
-  do{
-    GetRandEdge(&A1, &A2, nwp);
-    B2 = 1 + BIPARTITE + unif_rand() * (N_NODES-BIPARTITE);
-  }while(A2==B2 || IS_OUTEDGE(A1, B2));
+MH_P_FN(MH_CondB1Degree){  
+  CondDegreeSwap(MHp, nwp, BIPARTITE+1, N_NODES, FALSE);
+}
 
-//Rprintf("A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-//Rprintf("in A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-  Mtail[0]=A1; Mhead[0]=A2;
-  Mtail[1]=A1; Mhead[1]=B2;
+MH_I_FN(Mi_CondB2Degree){
+  CondDegreeSwapInit(MHp, nwp, BIPARTITE+1, N_NODES, 1, BIPARTITE, TRUE);
 }
 
 MH_P_FN(MH_CondB2Degree){  
-  Vertex A1, A2, B1;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=2;
-    return;
-  }
-
-  do{
-    GetRandEdge(&A1, &A2, nwp);
-    B1 = 1 + unif_rand() * BIPARTITE;
-  }while(A1==B1 || A2==B1 || IS_OUTEDGE(B1, A2));
-
-//Rprintf("A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-//Rprintf("in A1 %d A2 %d B1 %d B2 %d\n",A1,A2,B1,B2); 
-  Mtail[0]=A1; Mhead[0]=A2;
-  Mtail[1]=B1; Mhead[1]=A2;
+  CondDegreeSwap(MHp, nwp, 1, BIPARTITE, TRUE);
 }
@@ -10,250 +10,138 @@
 #include "ergm_MHproposal.h"
 #include "ergm_MHproposal_bd.h"
 #include "ergm_changestat.h"
-#include "ergm_edgelist.h"
+#include "ergm_dyad_hashmap.h"
 #include "ergm_MHstorage.h"
 
-/********************
-   void MH_dyadnoiseTNT
-   Tie/no tie:  Gives at least 50% chance of
-   proposing a toggle of an existing edge, as opposed
-   to simple random toggles that rarely do so in sparse 
-   networks
-
-   Takes an "observed" network and a list of precomputed ratios, and
-   tweaks the probability of the network by
-   p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
-
-   TODO: Proposals could almost certainly be more efficient.
-
-***********************/
-MH_I_FN(Mi_dyadnoiseTNT){
-  MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
-  MHp->ntoggles = 1;
-}
-
-MH_P_FN(MH_dyadnoiseTNT)
-{
-  /* *** don't forget tail-> head now */
-  static double comp=0.5;
-  static double odds, o0s0, o0s1, o1s0, o1s1;
-  static Edge ndyads;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=1;
-    odds = comp/(1.0-comp);
-    ndyads = DYADCOUNT(N_NODES, BIPARTITE, DIRECTED);
-    // o=observed, s=state
-    o0s0 = MHp->inputs[0]; o0s1 = MHp->inputs[1];
-    o1s0 = MHp->inputs[2]; o1s1 = MHp->inputs[3];
-    return;
+/* Storage shared by the dyad noise proposals.
+
+   Each dyad belongs to a noise class, and for each class, lr holds the
+   precomputed log-ratio adjustments in the order (observed 0, state
+   0), (observed 0, state 1), (observed 1, state 0), (observed 1,
+   state 1). codes maps a dyad onto 2*class + observed, so that the
+   adjustment for a dyad is lr[2*code + state] after a single lookup;
+   dyads absent from it are in class 0 and unobserved, so it only needs
+   to hold the observed edges and the dyads outside the most common
+   class. */
+typedef struct {
+  DegreeBound *bd;
+  double *lr;
+  StoreDyadMapUInt *codes;
+} StoreDyadNoise;
+
+#define DYADNOISE_LR(sto, tail, head, state) ((sto)->lr[2*GETDMUI((tail), (head), (sto)->codes) + ((state)!=0)])
+
+/* The inputs are the number of classes K, the 4*K log-ratio
+   adjustments, and the observed network as an edgelist; the integer
+   inputs are the number of dyads outside class 0, followed by their
+   tails, heads, and classes. */
+static StoreDyadNoise *DyadNoiseInitialize(MHProposal *MHp, Network *nwp){
+  MH_ALLOC_STORAGE(1, StoreDyadNoise, sto);
+  sto->bd = DegreeBoundInitializeR(MHp->R, nwp);
+
+  unsigned int nclasses = MH_INPUTS[0];
+  sto->lr = MH_INPUTS + 1;
+  double *obs = MH_INPUTS + 1 + 4*nclasses;
+
+  sto->codes = kh_init(DyadMapUInt);
+  sto->codes->directed = DIRECTED;
+
+  int *iinputs = MH_IINPUTS;
+  Dyad nexc = iinputs[0];
+  int *tails = iinputs + 1, *heads = tails + nexc, *classes = heads + nexc;
+  for(Dyad i = 0; i < nexc; i++)
+    SETDMUI0(tails[i], heads[i], 2*classes[i], sto->codes);
+
+  Edge nobs = obs[0];
+  for(Edge i = 0; i < nobs; i++){
+    Vertex tail = obs[1+i], head = obs[1+nobs+i];
+    unsigned int code = GETDMUI(tail, head, sto->codes);
+    SETDMUI0(tail, head, code | 1u, sto->codes);
   }
-  
-  BD_LOOP(MH_STORAGE, {
-      if (unif_rand() < comp && N_EDGES > 0) { /* Select a tie at random */
-	GetRandEdge(Mtail, Mhead, nwp);
-	/* Thanks to Robert Goudie for pointing out an error in the previous 
-	   version of this sampler when proposing to go from N_EDGES==0 to N_EDGES==1 
-	   or vice versa.  Note that this happens extremely rarely unless the 
-	   network is small or the parameter values lead to extremely sparse 
-	   networks.  */
-	MHp->logratio += log((N_EDGES==1 ? 1.0/(comp*ndyads + (1.0-comp)) :
-			      N_EDGES / (odds*ndyads + N_EDGES)));
 
-	int obs = dEdgeListSearch(Mtail[0],Mhead[0],MHp->inputs+4)!=0;	
-	MHp->logratio += obs?o1s1:o0s1;
-      }else{ /* Select a dyad at random */
-	GetRandDyad(Mtail, Mhead, nwp);
-
-	int obs = dEdgeListSearch(Mtail[0],Mhead[0],MHp->inputs+4)!=0;	
-
-	if(IS_OUTEDGE(Mtail[0],Mhead[0])!=0){
-	  MHp->logratio += log((N_EDGES==1 ? 1.0/(comp*ndyads + (1.0-comp)) :
-				N_EDGES / (odds*ndyads + N_EDGES)));
-	  MHp->logratio += obs?o1s1:o0s1;
-	}else{
-	  MHp->logratio += log((N_EDGES==0 ? comp*ndyads + (1.0-comp) :
-				1.0 + (odds*ndyads)/(N_EDGES + 1)));
-	  MHp->logratio += obs?o1s0:o0s0;
-	}
-      }
-    });
+  return sto;
 }
 
-MH_F_FN(Mf_dyadnoiseTNT){
-  DegreeBoundDestroy(MH_STORAGE);
+static void DyadNoiseDestroy(MHProposal *MHp){
+  MH_GET_STORAGE(StoreDyadNoise, sto);
+  DegreeBoundDestroy(sto->bd);
+  kh_destroy(DyadMapUInt, sto->codes);
 }
 
-
 /********************
-   void MH_dyadnoisemTNT
+   void MH_dyadnoiseTNT
    Tie/no tie:  Gives at least 50% chance of
    proposing a toggle of an existing edge, as opposed
-   to simple random toggles that rarely do so in sparse 
+   to simple random toggles that rarely do so in sparse
    networks
 
-   Takes an "observed" network and a list of precomputed ratio *matrices*, and
-   tweaks the probability of the network by
-   p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
-
-   TODO: Proposals could almost certainly be more efficient.
+   Takes an "observed" network and a table of precomputed log-ratio
+   adjustments for each noise class, and tweaks the probability of
+   the network by p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
 
 ***********************/
-MH_I_FN(Mi_dyadnoisemTNT){
-  MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
+MH_I_FN(Mi_dyadnoiseTNT){
+  DyadNoiseInitialize(MHp, nwp);
+  if(MHp->edge_index) NetworkEdgeIndexEnable(nwp);
   MHp->ntoggles = 1;
 }
 
-MH_P_FN(MH_dyadnoisemTNT)
-{
-  /* *** don't forget tail-> head now */  
-  static double comp=0.5;
-  static double odds, *o0s0, *o0s1, *o1s0, *o1s1, *onwp;
-  static Edge ndyads;
-  static Vertex ntails;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=1;
-    odds = comp/(1.0-comp);
-    ndyads = DYADCOUNT(N_NODES, BIPARTITE, DIRECTED);
-    // o=observed, s=state
-    unsigned int matsize = BIPARTITE? (N_NODES-BIPARTITE)*BIPARTITE : N_NODES*N_NODES;
-    o0s0 = MHp->inputs; o0s1 = MHp->inputs+matsize;
-    o1s0 = MHp->inputs+matsize*2; o1s1 = MHp->inputs+matsize*3;
-    onwp = MHp->inputs+matsize*4;
-    ntails = BIPARTITE? BIPARTITE:N_NODES;
-    return;
-  }
-  
-  BD_LOOP(MH_STORAGE, {
-      if (unif_rand() < comp && N_EDGES > 0) { /* Select a tie at random */
+MH_P_FN(Mp_dyadnoiseTNT){
+  MH_GET_STORAGE(StoreDyadNoise, sto);
+  /* *** don't forget tail-> head now */
+  const double P=0.5;
+  double Q = 1-P;
+  double DP = P*DYADCOUNT(nwp);
+  double DO = DP/Q;
+  Edge nedges = EDGECOUNT(nwp);
+
+  BD_LOOP(sto->bd, {
+      if (MH_UNIF_RAND() < P && nedges > 0) { /* Select a tie at random */
 	GetRandEdge(Mtail, Mhead, nwp);
-	/* Thanks to Robert Goudie for pointing out an error in the previous 
-	   version of this sampler when proposing to go from N_EDGES==0 to N_EDGES==1 
-	   or vice versa.  Note that this happens extremely rarely unless the 
-	   network is small or the parameter values lead to extremely sparse 
-	   networks.  */
-	MHp->logratio += log((N_EDGES==1 ? 1.0/(comp*ndyads + (1.0-comp)) :
-			      N_EDGES / (odds*ndyads + N_EDGES)));
-
-	int obs = dEdgeListSearch(Mtail[0],Mhead[0],onwp)!=0;	
-	MHp->logratio += (obs?o1s1:o0s1)[(Mtail[0]-1) + (Mhead[0]-1)*ntails]; // R matrix serialization is column-major.
+	MHp->logratio += TNT_LR_E(nedges, Q, DP, DO);
+	MHp->logratio += DYADNOISE_LR(sto, Mtail[0], Mhead[0], TRUE);
       }else{ /* Select a dyad at random */
 	GetRandDyad(Mtail, Mhead, nwp);
 
-	int obs = dEdgeListSearch(Mtail[0],Mhead[0],onwp)!=0;	
-
 	if(IS_OUTEDGE(Mtail[0],Mhead[0])!=0){
-	  MHp->logratio += log((N_EDGES==1 ? 1.0/(comp*ndyads + (1.0-comp)) :
-				N_EDGES / (odds*ndyads + N_EDGES)));
-	  MHp->logratio += (obs?o1s1:o0s1)[(Mtail[0]-1) + (Mhead[0]-1)*ntails]; // R matrix serialization is column-major.
+	  MHp->logratio += TNT_LR_DE(nedges, Q, DP, DO);
+	  MHp->logratio += DYADNOISE_LR(sto, Mtail[0], Mhead[0], TRUE);
 	}else{
-	  MHp->logratio += log((N_EDGES==0 ? comp*ndyads + (1.0-comp) :
-				1.0 + (odds*ndyads)/(N_EDGES + 1)));
-	  MHp->logratio += (obs?o1s0:o0s0)[(Mtail[0]-1) + (Mhead[0]-1)*ntails]; // R matrix serialization is column-major.
+	  MHp->logratio += TNT_LR_DN(nedges, Q, DP, DO);
+	  MHp->logratio += DYADNOISE_LR(sto, Mtail[0], Mhead[0], FALSE);
 	}
       }
     });
 }
 
-MH_F_FN(Mf_dyadnoisemTNT){
-  DegreeBoundDestroy(MH_STORAGE);
+MH_F_FN(Mf_dyadnoiseTNT){
+  DyadNoiseDestroy(MHp);
 }
 
 
 /********************
    void MH_dyadnoise
 
-   Takes an "observed" network and a list of precomputed ratios, and
-   tweaks the probability of the network by
-   p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
-
-   TODO: Proposals could almost certainly be more efficient.
+   Takes an "observed" network and a table of precomputed log-ratio
+   adjustments for each noise class, and tweaks the probability of
+   the network by p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
 
 ***********************/
 MH_I_FN(Mi_dyadnoise){
-  MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
+  DyadNoiseInitialize(MHp, nwp);
   MHp->ntoggles = 1;
 }
 
-MH_P_FN(MH_dyadnoise)
-{
+MH_P_FN(Mp_dyadnoise){
+  MH_GET_STORAGE(StoreDyadNoise, sto);
   /* *** don't forget tail-> head now */
-  
-  static double o0s0, o0s1, o1s0, o1s1;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=1;
-    // o=observed, s=state
-    o0s0 = MHp->inputs[0]; o0s1 = MHp->inputs[1];
-    o1s0 = MHp->inputs[2]; o1s1 = MHp->inputs[3];
-    return;
-  }
-  
-  BD_LOOP(MH_STORAGE, {
-      GetRandDyad(Mtail, Mhead, nwp);
-      
-      int obs = dEdgeListSearch(Mtail[0],Mhead[0],MHp->inputs+4)!=0;	
-      
-      if(IS_OUTEDGE(Mtail[0],Mhead[0])!=0){
-	MHp->logratio += obs?o1s1:o0s1;
-      }else{
-	MHp->logratio += obs?o1s0:o0s0;
-      }
-    });
-}
-
-MH_F_FN(Mf_dyadnoise){
-  DegreeBoundDestroy(MH_STORAGE);
-}
-
 
-/********************
-   void MH_dyadnoisem
-
-   Takes an "observed" network and a list of precomputed ratio *matrices*, and
-   tweaks the probability of the network by
-   p(nwp[i,j])to(obs[i,j]). (Network is passed second.)
-
-   TODO: Proposals could almost certainly be more efficient.
-
-***********************/
-MH_I_FN(Mi_dyadnoisem){
-  MH_STORAGE = DegreeBoundInitializeR(MHp->R, nwp);
-  MHp->ntoggles = 1;
-}
-
-MH_P_FN(MH_dyadnoisem)
-{
-  /* *** don't forget tail-> head now */
-  
-  static double *o0s0, *o0s1, *o1s0, *o1s1, *onwp;
-  static Vertex ntails;
-  
-  if(MHp->ntoggles == 0) { /* Initialize */
-    MHp->ntoggles=1;
-    // o=observed, s=state
-    unsigned int matsize = BIPARTITE? (N_NODES-BIPARTITE)*BIPARTITE : N_NODES*N_NODES;
-    o0s0 = MHp->inputs; o0s1 = MHp->inputs+matsize;
-    o1s0 = MHp->inputs+matsize*2; o1s1 = MHp->inputs+matsize*3;
-    onwp = MHp->inputs+matsize*4;
-    ntails = BIPARTITE? BIPARTITE:N_NODES;
-    return;
-  }
-  
-  BD_LOOP(MH_STORAGE, {
+  BD_LOOP(sto->bd, {
       GetRandDyad(Mtail, Mhead, nwp);
-
-      int obs = dEdgeListSearch(Mtail[0],Mhead[0],onwp)!=0;	
-
-      if(IS_OUTEDGE(Mtail[0],Mhead[0])!=0){
-	MHp->logratio += (obs?o1s1:o0s1)[(Mtail[0]-1) + (Mhead[0]-1)*ntails]; // R matrix serialization is column-major.
-      }else{
-	MHp->logratio += (obs?o1s0:o0s0)[(Mtail[0]-1) + (Mhead[0]-1)*ntails]; // R matrix serialization is column-major.
-      }
+      MHp->logratio += DYADNOISE_LR(sto, Mtail[0], Mhead[0], IS_OUTEDGE(Mtail[0],Mhead[0]));
     });
 }
 
-MH_F_FN(Mf_dyadnoisem){
-  DegreeBoundDestroy(MH_STORAGE);
+MH_F_FN(Mf_dyadnoise){
+  DyadNoiseDestroy(MHp);
 }
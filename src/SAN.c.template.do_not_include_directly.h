@@ -257,7 +257,7 @@ MCMCStatus DISPATCH_SANMetropolisHastings(DISPATCH_ErgmState *s,
     }
     
     /* if we accept the proposed network */
-    if (tau[0]==0? ip - offsetcontrib <= 0 : ip/tau[0] - offsetcontrib <= -log(unif_rand()) ) { 
+    if (tau[0]==0? ip - offsetcontrib <= 0 : ip/tau[0] - offsetcontrib <= -log(MH_UNIF_RAND()) ) { 
       if(verbose>=5){
 	Rprintf("Accepted.\n");
       }
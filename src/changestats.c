@@ -11,6 +11,8 @@
 #include "ergm_storage.h"
 #include "ergm_dyad_hashmap.h"
 #include "ergm_edgelist.h"
+#include "changestats_attrnbr.h"
+#include "ergm_nodeswap.h"
 
 /********************  changestats:  A    ***********/
 /*****************                       
@@ -476,6 +478,7 @@ C_CHANGESTAT_FN(c_b1nodematch) {
  changestat: d_b1starmix
 *****************/
 C_CHANGESTAT_FN(c_b1starmix) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   double change;
   int j, kmo;
   Edge e;
@@ -494,6 +497,8 @@ C_CHANGESTAT_FN(c_b1starmix) {
     headattr = INPUT_ATTRIB[head-1];
     taild = -(int)edgestate; /* if edge exists set to -1 because it will be recounted */
 
+    if(an) taild += ATTRNBR_OUTCOUNT(an, tail, (int)headattr);
+    else
     STEP_THROUGH_OUTEDGES(tail, e, node3) { /* step through outedges of tail */
       if(headattr == INPUT_ATTRIB[node3-1]){++taild;}
     }
@@ -510,6 +515,7 @@ C_CHANGESTAT_FN(c_b1starmix) {
  changestat: d_b1starmixhomophily
 *****************/
 C_CHANGESTAT_FN(c_b1starmixhomophily) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   double change;
   int j, kmo;
   Edge e;
@@ -527,6 +533,8 @@ C_CHANGESTAT_FN(c_b1starmixhomophily) {
     headattr = INPUT_ATTRIB[head-1];
     taild = -(int)edgestate; /* if edge exists set to -1 because it will be recounted */
 
+    if(an) taild += ATTRNBR_OUTCOUNT(an, tail, (int)headattr);
+    else
     STEP_THROUGH_OUTEDGES(tail, e, node3) { /* step through outedges of tail */
       if(headattr == INPUT_ATTRIB[node3-1]){++taild;}
     }
@@ -891,6 +899,7 @@ C_CHANGESTAT_FN(c_b2nodematch) {
  changestat: d_b2starmix
 *****************/
 C_CHANGESTAT_FN(c_b2starmix) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   double change;
   int j, kmo;
   Edge e;
@@ -910,6 +919,8 @@ C_CHANGESTAT_FN(c_b2starmix) {
     headattr = INPUT_ATTRIB[head-1];
     headd = -(int)edgestate; /* if edge exists set to -1 because it will be recounted */
 
+    if(an) headd += ATTRNBR_INCOUNT(an, head, (int)tailattr);
+    else
     STEP_THROUGH_INEDGES(head, e, node3) { /* step through inedges of head */
       if(tailattr == INPUT_ATTRIB[node3-1]){++headd;}
     }
@@ -926,6 +937,7 @@ C_CHANGESTAT_FN(c_b2starmix) {
  changestat: d_b2starmixhomophily
 *****************/
 C_CHANGESTAT_FN(c_b2starmixhomophily) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   double change;
   int j, kmo;
   Edge e;
@@ -943,6 +955,8 @@ C_CHANGESTAT_FN(c_b2starmixhomophily) {
     headattr = INPUT_ATTRIB[head-1];
     headd = -(int)edgestate; /* if edge exists set to -1 because it will be recounted */
 
+    if(an) headd += ATTRNBR_INCOUNT(an, head, (int)tailattr);
+    else
     STEP_THROUGH_INEDGES(head, e, node3) { /* step through inedges of head */
       if(tailattr == INPUT_ATTRIB[node3-1]){++headd;}
     }
@@ -1440,6 +1454,7 @@ C_CHANGESTAT_FN(c_concurrent_by_attr) {
  changestat: d_ctriple
 *****************/
 C_CHANGESTAT_FN(c_ctriple) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   Edge e;
   Vertex change, node3;
   int j;
@@ -1451,10 +1466,25 @@ C_CHANGESTAT_FN(c_ctriple) {
     if(N_INPUT_PARAMS > 0){ /* match on attributes */
       tailattr = INPUT_ATTRIB[tail-1];
       if(tailattr == INPUT_ATTRIB[head-1]) {
+        if(an){
+          /* Either the matching outedges of head or the matching
+             inedges of tail, whichever are fewer. */
+          int l = tailattr;
+          if(ATTRNBR_OUTCOUNT(an, head, l) <= ATTRNBR_INCOUNT(an, tail, l)){
+            EXEC_THROUGH_ATTRNBR_OUTLIST(an, head, l, node3, {
+                change += IS_OUTEDGE(node3, tail);
+              });
+          }else{
+            EXEC_THROUGH_ATTRNBR_INLIST(an, tail, l, node3, {
+                change += IS_OUTEDGE(head, node3);
+              });
+          }
+        }else{
         STEP_THROUGH_OUTEDGES(head, e, node3) { /* step through outedges of head */
           if(tailattr == INPUT_ATTRIB[node3-1])
             change += IS_OUTEDGE(node3, tail);
         }
+        }
         if(N_CHANGE_STATS > 1) { /* diff = TRUE; matches must be tabled */
           for (j=0; j<N_CHANGE_STATS; j++){
             if (tailattr == INPUT_PARAM[j])
@@ -1773,6 +1803,7 @@ C_CHANGESTAT_FN(c_degrange_w_homophily) {
   The first 2*nstats values are the values of degrange
   The values following the first 2*nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j;
   Vertex taildeg, headdeg, v;
   double *nodeattr;
@@ -1786,10 +1817,15 @@ C_CHANGESTAT_FN(c_degrange_w_homophily) {
       int echange = edgestate ? -1:1;
       taildeg=headdeg=-1; /* since tailattr==headattr, subtract the automatic match */
       taildeg=headdeg=0;
+      if(an){
+        taildeg = ATTRNBR_COUNT(an, tail, tailattr);
+        headdeg = ATTRNBR_COUNT(an, head, headattr);
+      }else{
       STEP_THROUGH_OUTEDGES(tail, e, v) { taildeg += (nodeattr[v]==tailattr); }
       STEP_THROUGH_INEDGES(tail, e, v) { taildeg += (nodeattr[v]==tailattr); }
       STEP_THROUGH_OUTEDGES(head, e, v) { headdeg += (nodeattr[v]==headattr); }
       STEP_THROUGH_INEDGES(head, e, v) { headdeg += (nodeattr[v]==headattr); }
+      }
       for(j = 0; j < N_CHANGE_STATS; j++) {
         Vertex from = INPUT_PARAM[2*j], to = INPUT_PARAM[2*j+1];
         CHANGE_STAT[j] += FROM_TO(taildeg + echange, from, to) - FROM_TO(taildeg, from, to);
@@ -1883,6 +1919,7 @@ C_CHANGESTAT_FN(c_degree_w_homophily) {
   The first nstats values are the values of degree
   The values following the first nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j, echange, tailattr, headattr;
   Vertex taildeg, headdeg, deg, v;
   double *nodeattr;
@@ -1897,10 +1934,15 @@ C_CHANGESTAT_FN(c_degree_w_homophily) {
       echange = edgestate ? -1:1;
       taildeg=headdeg=-1; /* since tailattr==headattr, subtract the automatic match */
       taildeg=headdeg=0;
+      if(an){
+        taildeg = ATTRNBR_COUNT(an, tail, tailattr);
+        headdeg = ATTRNBR_COUNT(an, head, headattr);
+      }else{
       STEP_THROUGH_OUTEDGES(tail, e, v) { taildeg += (nodeattr[v]==tailattr); }
       STEP_THROUGH_INEDGES(tail, e, v) { taildeg += (nodeattr[v]==tailattr); }
       STEP_THROUGH_OUTEDGES(head, e, v) { headdeg += (nodeattr[v]==headattr); }
       STEP_THROUGH_INEDGES(head, e, v) { headdeg += (nodeattr[v]==headattr); }
+      }
       for(j = 0; j < N_CHANGE_STATS; j++) {
         deg = (Vertex)INPUT_PARAM[j];
         CHANGE_STAT[j] += (taildeg + echange == deg) - (taildeg == deg);
@@ -2180,6 +2222,12 @@ C_CHANGESTAT_FN(c_edges) {
   CHANGE_STAT[0] = edgestate ? - 1 : 1;
 }
 
+X_CHANGESTAT_FN(x_edges) {
+  GET_NODESWAP(ns);
+  // Relabeling vertices does not change the number of edges.
+  ns->handled = TRUE;
+}
+
 S_CHANGESTAT_FN(s_edges) {
   CHANGE_STAT[0] = N_EDGES;
 }
@@ -3189,6 +3237,7 @@ C_CHANGESTAT_FN(c_idegrange_w_homophily) {
   The first 2*nstats values are the values of idegrange
   The values following the first 2*nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j;
   double *nodeattr;
   Edge e;
@@ -3200,7 +3249,8 @@ C_CHANGESTAT_FN(c_idegrange_w_homophily) {
     if (headattr == tailattr) { /* They match; otherwise don't bother */
       int echange = edgestate ? -1:1;
       Vertex headideg=0, v;
-      STEP_THROUGH_INEDGES(head, e, v) { headideg += (nodeattr[v]==headattr); }
+      if(an) headideg = ATTRNBR_INCOUNT(an, head, headattr);
+      else STEP_THROUGH_INEDGES(head, e, v) { headideg += (nodeattr[v]==headattr); }
       for(j = 0; j < N_CHANGE_STATS; j++) {
         Vertex from = INPUT_PARAM[2*j], to = INPUT_PARAM[2*j+1];
         CHANGE_STAT[j] += FROM_TO(headideg + echange, from, to) - FROM_TO(headideg, from, to);
@@ -3259,6 +3309,7 @@ C_CHANGESTAT_FN(c_idegree_w_homophily) {
   The first nstats values are the values of degree
   The values following the first nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j, echange, tailattr, headattr;
   Vertex headdeg, deg, tmp;
   double *nodeattr;
@@ -3272,6 +3323,8 @@ C_CHANGESTAT_FN(c_idegree_w_homophily) {
     if (tailattr == headattr) { /* They match; otherwise don't bother */
       echange=edgestate ? -1 : +1;
       headdeg=0;
+      if(an) headdeg = ATTRNBR_INCOUNT(an, head, headattr);
+      else
       STEP_THROUGH_INEDGES(head, e, tmp){
         headdeg += (nodeattr[tmp]==headattr);
       }
@@ -3450,22 +3503,6 @@ C_CHANGESTAT_FN(c_isolates) {
       
 }
 
-S_CHANGESTAT_FN(s_isolates) { 
-  /* int  echange;
-     Vertex taild, headd=0, *id, *od; */
-  Vertex *id, *od;
-
-  id=IN_DEG;
-  od=OUT_DEG;
-  
-  /* *** don't forget tail -> head */    
-  CHANGE_STAT[0] = 0.0;
-  for(Vertex tail=1; tail <= N_NODES; tail++){
-    if(od[tail] + id[tail] == 0)
-      CHANGE_STAT[0] ++;
-  }
-}
-
 /*****************
  changestat: d_istar
 *****************/
@@ -3782,6 +3819,11 @@ C_CHANGESTAT_FN(c_nodecov) {
     }
 }
 
+X_CHANGESTAT_FN(x_nodecov) {
+  GET_NODESWAP(ns);
+  NodeSwapDyadIndependent(ns, mtp, nwp);
+}
+
 /*****************
  changestat: d_nodefactor
 *****************/
@@ -3793,6 +3835,11 @@ C_CHANGESTAT_FN(c_nodefactor) {
   if (headpos!=-1) CHANGE_STAT[headpos] += s;
 }
 
+X_CHANGESTAT_FN(x_nodefactor) {
+  GET_NODESWAP(ns);
+  NodeSwapDyadIndependent(ns, mtp, nwp);
+}
+
 /*****************
  changestat: d_nodeicov
 *****************/
@@ -3839,6 +3886,11 @@ C_CHANGESTAT_FN(c_nodematch) {
     }
 }
 
+X_CHANGESTAT_FN(x_nodematch) {
+  GET_NODESWAP(ns);
+  NodeSwapDyadIndependent(ns, mtp, nwp);
+}
+
 /*****************
  changestat: nodemix
 *****************/
@@ -3870,6 +3922,11 @@ C_CHANGESTAT_FN(c_nodemix) {
   }
 }
 
+X_CHANGESTAT_FN(x_nodemix) {
+  GET_NODESWAP(ns);
+  NodeSwapDyadIndependent(ns, mtp, nwp);
+}
+
 F_CHANGESTAT_FN(f_nodemix) {
   GET_STORAGE(nodemix_storage, sto);
   Free(sto->indmat);  
@@ -4143,6 +4200,7 @@ C_CHANGESTAT_FN(c_odegrange_w_homophily) {
   The first 2*nstats values are the values of odegrange
   The values following the first 2*nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j;
   double *nodeattr;
   Edge e;
@@ -4154,7 +4212,8 @@ C_CHANGESTAT_FN(c_odegrange_w_homophily) {
     if (tailattr == headattr) { /* They match; otherwise don't bother */
       int echange = edgestate ? -1:1;
       Vertex tailodeg=0, v;
-      STEP_THROUGH_OUTEDGES(tail, e, v) { tailodeg += (nodeattr[v]==tailattr); }
+      if(an) tailodeg = ATTRNBR_OUTCOUNT(an, tail, tailattr);
+      else STEP_THROUGH_OUTEDGES(tail, e, v) { tailodeg += (nodeattr[v]==tailattr); }
       for(j = 0; j < N_CHANGE_STATS; j++) {
         Vertex from = INPUT_PARAM[2*j], to = INPUT_PARAM[2*j+1];
         CHANGE_STAT[j] += FROM_TO(tailodeg + echange, from, to) - FROM_TO(tailodeg, from, to);
@@ -4214,6 +4273,7 @@ C_CHANGESTAT_FN(c_odegree_w_homophily) {
   The first nstats values are the values of degree
   The values following the first nstats values are the nodal attributes.
   */
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   int j;
   double *nodeattr;
   Edge e;
@@ -4225,6 +4285,8 @@ C_CHANGESTAT_FN(c_odegree_w_homophily) {
     if (tailattr == headattr) { /* They match; otherwise don't bother */
       int echange=edgestate ? -1 : +1;
       Vertex taildeg=0, tmp;
+      if(an) taildeg = ATTRNBR_OUTCOUNT(an, tail, tailattr);
+      else
       STEP_THROUGH_OUTEDGES(tail, e, tmp){
         taildeg += (nodeattr[tmp]==tailattr);
       }
@@ -4904,7 +4966,7 @@ C_CHANGESTAT_FN(c_transitive) {
 //  Rprintf("tail %d head %d edgestate %d change %f C_S[0]=%f\n", tail, head, change,CHANGE_STAT[0]);
 }
 
-C_CHANGESTAT_FN(c_transitiveties) { 
+C_CHANGESTAT_FN_SPECIALIZED(c_transitiveties) { 
   int  echange, ochange;
   int L2th, L2tu, L2uh;
   double cumchange;
@@ -4993,7 +5055,7 @@ C_CHANGESTAT_FN(c_transitiveties) {
     (CHANGE_STAT[0]) += cumchange;
 }
 
-C_CHANGESTAT_FN(c_cyclicalties) { 
+C_CHANGESTAT_FN_SPECIALIZED(c_cyclicalties) { 
   int  echange, ochange;
   int L2th, L2tu, L2uh;
   double cumchange;
@@ -5354,6 +5416,7 @@ C_CHANGESTAT_FN(c_triadcensus) {
  changestat: d_triangle
 *****************/
 C_CHANGESTAT_FN(c_triangle) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   Edge e;
   Vertex change, node3;
   int j;
@@ -5365,6 +5428,28 @@ C_CHANGESTAT_FN(c_triangle) {
     if(N_INPUT_PARAMS>0){ /* match on attributes */
       tailattr = INPUT_ATTRIB[tail-1];
       if(tailattr == INPUT_ATTRIB[head-1]){
+        if(an){
+          /* The count is symmetric in tail and head, so step through
+             the matching neighbors of whichever has fewer. */
+          int l = tailattr;
+          Vertex a = head, b = tail;
+          if(ATTRNBR_OUTCOUNT(an, tail, l) + ATTRNBR_INCOUNT(an, tail, l) <
+             ATTRNBR_OUTCOUNT(an, head, l) + ATTRNBR_INCOUNT(an, head, l)){
+            a = tail; b = head;
+          }
+          if(DIRECTED){
+            EXEC_THROUGH_ATTRNBR_OUTLIST(an, a, l, node3, {
+                change += IS_OUTEDGE(node3, b) + IS_INEDGE(node3, b);
+              });
+            EXEC_THROUGH_ATTRNBR_INLIST(an, a, l, node3, {
+                change += IS_OUTEDGE(node3, b) + IS_INEDGE(node3, b);
+              });
+          }else{
+            EXEC_THROUGH_ATTRNBR_LIST(an, a, l, node3, {
+                change += IS_UNDIRECTED_EDGE(node3, b);
+              });
+          }
+        }else{
         STEP_THROUGH_OUTEDGES(head, e, node3) { /* step through outedges of head */
           if(tailattr == INPUT_ATTRIB[node3-1]){
             if (DIRECTED) change += IS_OUTEDGE(node3, tail) + IS_INEDGE(node3, tail);
@@ -5377,6 +5462,7 @@ C_CHANGESTAT_FN(c_triangle) {
             else change += IS_UNDIRECTED_EDGE(node3,tail);
           }
         }
+        }
         if(N_CHANGE_STATS>1){ /* diff = TRUE */
           for (j=0; j<N_CHANGE_STATS; j++){
             if (tailattr == INPUT_PARAM[j])
@@ -5473,6 +5559,7 @@ C_CHANGESTAT_FN(c_tripercent) {
  changestat: d_ttriple
 *****************/
 C_CHANGESTAT_FN(c_ttriple) { 
+  StoreAttrNbr *an = N_AUX ? AUX_STORAGE : NULL;
   Edge e;
   Vertex change, node3;
   int j;
@@ -5484,6 +5571,15 @@ C_CHANGESTAT_FN(c_ttriple) {
     if(N_INPUT_PARAMS > 0){ /* match on attributes */
       tailattr = INPUT_ATTRIB[tail-1];
       if(tailattr == INPUT_ATTRIB[head-1]) {
+        if(an){
+          int l = tailattr;
+          EXEC_THROUGH_ATTRNBR_OUTLIST(an, head, l, node3, {
+              change += IS_INEDGE(node3, tail);
+            });
+          EXEC_THROUGH_ATTRNBR_INLIST(an, head, l, node3, {
+              change += IS_OUTEDGE(node3, tail) + IS_INEDGE(node3, tail);
+            });
+        }else{
         STEP_THROUGH_OUTEDGES(head, e, node3) { /* step through outedges of head */
           if(tailattr == INPUT_ATTRIB[node3-1])
             change += IS_INEDGE(node3, tail);
@@ -5492,6 +5588,7 @@ C_CHANGESTAT_FN(c_ttriple) {
           if(tailattr == INPUT_ATTRIB[node3-1])
             change += IS_OUTEDGE(node3, tail) + IS_INEDGE(node3, tail);
         }
+        }
         if(N_CHANGE_STATS > 1) { /* diff = TRUE; matches must be tabled */
           for (j=0; j<N_CHANGE_STATS; j++){
             if (tailattr == INPUT_PARAM[j])
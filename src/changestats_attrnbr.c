@@ -0,0 +1,123 @@
+/*  File src/changestats_attrnbr.c in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#include "changestats_attrnbr.h"
+
+/* Record u as a neighbor of v in the given count array and (if not
+   NULL) list. */
+static inline void AttrNbrAdd(Vertex v, Vertex u, StoreAttrNbr *an,
+                              unsigned int *count, Vertex **list, unsigned int *cap, StoreDyadMapUInt *pos){
+  Dyad i = ATTRNBR_IDX(an, v, ATTRNBR_ATTR(an, u));
+  if(list){
+    if(count[i] == cap[i]){
+      cap[i] = cap[i] ? cap[i]*2 : 4;
+      list[i] = Realloc(list[i], cap[i], Vertex);
+    }
+    list[i][count[i]] = u;
+    SETDMUI0(v, u, count[i], pos);
+  }
+  count[i]++;
+}
+
+/* Remove u from v's neighbors, moving the last neighbor in the list
+   into its place. */
+static inline void AttrNbrDel(Vertex v, Vertex u, StoreAttrNbr *an,
+                              unsigned int *count, Vertex **list, StoreDyadMapUInt *pos){
+  Dyad i = ATTRNBR_IDX(an, v, ATTRNBR_ATTR(an, u));
+  count[i]--;
+  if(list){
+    unsigned int p = GETDMUI(v, u, pos);
+    DELDMUI(v, u, pos);
+    if(p != count[i]){
+      Vertex w = list[i][count[i]];
+      list[i][p] = w;
+      SETDMUI0(v, w, p, pos);
+    }
+  }
+}
+
+static inline void AttrNbrToggle(Vertex tail, Vertex head, StoreAttrNbr *an, Rboolean edgestate){
+  if(edgestate){
+    AttrNbrDel(tail, head, an, an->outcount, an->outlist, an->outpos);
+    AttrNbrDel(head, tail, an, an->incount, an->inlist, an->inpos);
+  }else{
+    AttrNbrAdd(tail, head, an, an->outcount, an->outlist, an->outcap, an->outpos);
+    AttrNbrAdd(head, tail, an, an->incount, an->inlist, an->incap, an->inpos);
+  }
+}
+
+/*****************
+ Auxiliary: _attrnbr_net
+
+ Maintains a StoreAttrNbr. IINPUT_PARAM[0] is nonzero if the neighbor
+ lists are to be maintained in addition to the counts,
+ IINPUT_PARAM[1] is the number of levels, and the remaining
+ N_NODES inputs are the levels of the vertices.
+*****************/
+
+I_CHANGESTAT_FN(i__attrnbr_net){
+  ALLOC_AUX_STORAGE(1, StoreAttrNbr, an);
+  Rboolean lists = IINPUT_PARAM[0];
+  an->nlevels = IINPUT_PARAM[1];
+  an->attr = IINPUT_PARAM + 2;
+  Dyad size = (Dyad)N_NODES*an->nlevels;
+
+  an->outcount = Calloc(size, unsigned int);
+  if(lists){
+    an->outlist = Calloc(size, Vertex *);
+    an->outcap = Calloc(size, unsigned int);
+    an->outpos = kh_init(DyadMapUInt); an->outpos->directed = TRUE;
+  }
+
+  if(DIRECTED){
+    an->incount = Calloc(size, unsigned int);
+    if(lists){
+      an->inlist = Calloc(size, Vertex *);
+      an->incap = Calloc(size, unsigned int);
+      an->inpos = kh_init(DyadMapUInt); an->inpos->directed = TRUE;
+    }
+  }else{
+    an->incount = an->outcount;
+    an->inlist = an->outlist;
+    an->incap = an->outcap;
+    an->inpos = an->outpos;
+  }
+
+  EXEC_THROUGH_NET_EDGES(t, h, e, {
+      AttrNbrToggle(t, h, an, FALSE);
+    });
+}
+
+U_CHANGESTAT_FN(u__attrnbr_net){
+  GET_AUX_STORAGE(StoreAttrNbr, an);
+  AttrNbrToggle(tail, head, an, edgestate);
+}
+
+F_CHANGESTAT_FN(f__attrnbr_net){
+  GET_AUX_STORAGE(StoreAttrNbr, an);
+  Dyad size = (Dyad)N_NODES*an->nlevels;
+
+  if(an->outlist){
+    for(Dyad i = 0; i < size; i++) Free(an->outlist[i]);
+    Free(an->outlist);
+    Free(an->outcap);
+    kh_destroy(DyadMapUInt, an->outpos);
+  }
+  if(DIRECTED){
+    if(an->inlist){
+      for(Dyad i = 0; i < size; i++) Free(an->inlist[i]);
+      Free(an->inlist);
+      Free(an->incap);
+      kh_destroy(DyadMapUInt, an->inpos);
+    }
+    Free(an->incount);
+  }
+  Free(an->outcount);
+  // an itself is freed by the framework.
+}
@@ -0,0 +1,76 @@
+/*  File src/changestats_attrnbr.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _CHANGESTATS_ATTRNBR_H_
+#define _CHANGESTATS_ATTRNBR_H_
+
+#include "ergm_edgetree.h"
+#include "ergm_changestat.h"
+#include "ergm_storage.h"
+#include "ergm_dyad_hashmap.h"
+
+/* Storage for the attribute-indexed neighbor auxiliary.
+
+   attr[v-1] is the level (1..nlevels) of vertex v. For each vertex v
+   and level l, outcount holds the number of out-neighbors of v with
+   level l, and incount the number of its in-neighbors. For undirected
+   networks, incount is the same array as outcount and holds the
+   number of neighbors.
+
+   If the neighbor lists were requested, outlist (and inlist) hold the
+   neighbors themselves, in no particular order, so that
+   ATTRNBR_OUTLIST(an, v, l)[0..ATTRNBR_OUTCOUNT(an, v, l)-1] are the
+   out-neighbors of v with level l; outpos maps (v, u) to the position
+   of u in v's list, so that it can be removed in constant time.
+   Otherwise, they are NULL.
+*/
+typedef struct StoreAttrNbrstruct {
+  unsigned int nlevels;
+  int *attr;
+  unsigned int *outcount, *incount;
+
+  Vertex **outlist, **inlist;
+  unsigned int *outcap, *incap;
+  StoreDyadMapUInt *outpos, *inpos;
+} StoreAttrNbr;
+
+#define ATTRNBR_IDX(an, v, l) ((Dyad)((v)-1)*(an)->nlevels + (l)-1)
+#define ATTRNBR_ATTR(an, v) ((an)->attr[(v)-1])
+
+#define ATTRNBR_OUTCOUNT(an, v, l) ((an)->outcount[ATTRNBR_IDX(an, v, l)])
+#define ATTRNBR_INCOUNT(an, v, l) ((an)->incount[ATTRNBR_IDX(an, v, l)])
+#define ATTRNBR_COUNT(an, v, l) ATTRNBR_OUTCOUNT(an, v, l)
+
+#define ATTRNBR_OUTLIST(an, v, l) ((an)->outlist[ATTRNBR_IDX(an, v, l)])
+#define ATTRNBR_INLIST(an, v, l) ((an)->inlist[ATTRNBR_IDX(an, v, l)])
+#define ATTRNBR_LIST(an, v, l) ATTRNBR_OUTLIST(an, v, l)
+
+/* Execute subroutine for each out-neighbor (neighbor, if undirected)
+   u of v with level l. The lists must have been requested. */
+#define EXEC_THROUGH_ATTRNBR_OUTLIST(an, v, l, u, subroutine){          \
+    Dyad _i = ATTRNBR_IDX(an, v, l);                                    \
+    Vertex *_list = (an)->outlist[_i];                                  \
+    for(unsigned int _j = 0; _j < (an)->outcount[_i]; _j++){            \
+      Vertex u = _list[_j];                                             \
+      subroutine;                                                       \
+    }                                                                   \
+  }
+
+#define EXEC_THROUGH_ATTRNBR_INLIST(an, v, l, u, subroutine){           \
+    Dyad _i = ATTRNBR_IDX(an, v, l);                                    \
+    Vertex *_list = (an)->inlist[_i];                                   \
+    for(unsigned int _j = 0; _j < (an)->incount[_i]; _j++){             \
+      Vertex u = _list[_j];                                             \
+      subroutine;                                                       \
+    }                                                                   \
+  }
+
+#define EXEC_THROUGH_ATTRNBR_LIST(an, v, l, u, subroutine) EXEC_THROUGH_ATTRNBR_OUTLIST(an, v, l, u, subroutine)
+
+#endif // _CHANGESTATS_ATTRNBR_H_
@@ -12,6 +12,22 @@
 #include "ergm_dyad_hashmap.h"
 #include "ergm_dyad_hashmap_utils.h"
 
+/* edgelist_index:
+   indexes the reference edgelist for the auxiliary networks that
+   need to check toggles against it; shared by all of them that use
+   the same edgelist
+*/
+
+I_CHANGESTAT_FN(i__edgelist_index){
+  ALLOC_AUX_STORAGE(1, EdgeListIndex, idx);
+  EdgeListIndexInitialize(idx, IINPUT_PARAM);
+}
+
+F_CHANGESTAT_FN(f__edgelist_index){
+  GET_AUX_STORAGE(EdgeListIndex, idx);
+  EdgeListIndexDestroy(idx);
+}
+
 // sets aux network to y0 XOR y1
 I_CHANGESTAT_FN(i__discord_net_Network){
   I_AUXNET(NetworkCopy(nwp));
@@ -52,9 +68,9 @@ I_CHANGESTAT_FN(i__intersect_net_Network){
 
 U_CHANGESTAT_FN(u__intersect_net_Network){
   GET_AUX_STORAGE(StoreAuxnet, auxnet);
-  int *ref_el = IINPUT_PARAM;
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
   // only toggle if the edge is in y0. otherwise changing y1 won't matter.
-  if(iEdgeListSearch(tail, head, ref_el))
+  if(EdgeListIndexSearch(tail, head, idx))
     ToggleEdge(tail, head, auxnet->onwp);
 }
 
@@ -105,9 +121,9 @@ I_CHANGESTAT_FN(i__union_net_Network){
 
 U_CHANGESTAT_FN(u__union_net_Network){
   GET_AUX_STORAGE(StoreAuxnet, auxnet);
-  int *ref_el = IINPUT_PARAM;
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
   // If the edge is in y0, changing y1 won't matter.
-  if(iEdgeListSearch(tail, head, ref_el)==0)
+  if(EdgeListIndexSearch(tail, head, idx)==0)
     ToggleEdge(tail, head, auxnet->onwp);
 }
 
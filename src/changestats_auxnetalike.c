@@ -91,10 +91,10 @@ I_CHANGESTAT_FN(i__intersect_net_DyadSet){
 
 U_CHANGESTAT_FN(u__intersect_net_DyadSet){
   GET_AUX_STORAGE(StoreDyadSetAndRefEL, storage);
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
   StoreDyadSet *dnwp = storage->nwp;
-  int *ref_el = storage->ref_el;
   // only toggle if the edge is in y0. otherwise changing y1 won't matter.
-  if(iEdgeListSearch(tail, head, ref_el))
+  if(EdgeListIndexSearch(tail, head, idx))
     DyadSetToggle(tail,head, dnwp);
 }
 
@@ -147,10 +147,10 @@ I_CHANGESTAT_FN(i__union_net_DyadSet){
 
 U_CHANGESTAT_FN(u__union_net_DyadSet){
   GET_AUX_STORAGE(StoreDyadSetAndRefEL, storage);
+  GET_AUX_STORAGE_NUM(EdgeListIndex, idx, 1);
   StoreDyadSet *dnwp = storage->nwp;
-  int *ref_el = storage->ref_el;
   // If the edge is in y0, changing y1 won't matter.
-  if(iEdgeListSearch(tail, head, ref_el)==0)
+  if(EdgeListIndexSearch(tail, head, idx)==0)
     DyadSetToggle(tail,head, dnwp);
 }
 
@@ -0,0 +1,184 @@
+/*  File src/changestats_degreedist.c in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#include "changestats_degreedist.h"
+
+/* Tabulate the degrees of vertices first..last of nwp into dd. */
+void DegreeDistInitialize(StoreDegreeDist *dd, unsigned int mode, Vertex first, Vertex last, double *attr, Network *nwp){
+  dd->mode = mode;
+  dd->first = first;
+  dd->last = last;
+  dd->attr = attr;
+
+  dd->nlevels = 1;
+  if(attr)
+    for(Vertex v = first; v <= last; v++)
+      dd->nlevels = MAX(dd->nlevels, DEGREEDIST_LEVEL(dd, v));
+
+  dd->nnodes = Calloc(dd->nlevels, Vertex);
+  dd->top = Calloc(dd->nlevels, Vertex);
+  dd->hist = Calloc(dd->nlevels, Vertex *);
+
+  for(Vertex v = first; v <= last; v++){
+    unsigned int l = DEGREEDIST_LEVEL(dd, v) - 1;
+    dd->nnodes[l]++;
+    dd->top[l] = MAX(dd->top[l], DEGREEDIST_DEG(dd, v, nwp));
+  }
+
+  for(unsigned int l = 0; l < dd->nlevels; l++)
+    dd->hist[l] = Calloc(dd->top[l] + 1, Vertex);
+
+  for(Vertex v = first; v <= last; v++)
+    dd->hist[DEGREEDIST_LEVEL(dd, v) - 1][DEGREEDIST_DEG(dd, v, nwp)]++;
+}
+
+void DegreeDistDestroy(StoreDegreeDist *dd){
+  for(unsigned int l = 0; l < dd->nlevels; l++) Free(dd->hist[l]);
+  Free(dd->hist);
+  Free(dd->top);
+  Free(dd->nnodes);
+}
+
+/*****************
+ Summary statistics for the degree distribution terms
+
+ Each is computed from the degree distribution, tabulated on the
+ spot, in time linear in the number of vertices rather than in the
+ number of edges. The variants for different kinds of degree differ
+ only in the tabulation.
+*****************/
+
+typedef void (*DegreeDistSummary)(ModelTerm *mtp, StoreDegreeDist *dd);
+
+static inline void DegreeDistSumm(ModelTerm *mtp, Network *nwp, DegreeDistSummary summ,
+                                  unsigned int mode, Vertex first, Vertex last, double *attr){
+  StoreDegreeDist dd;
+  DegreeDistInitialize(&dd, mode, first, last, attr, nwp);
+  summ(mtp, &dd);
+  DegreeDistDestroy(&dd);
+}
+
+/* Number of vertices with level l whose degree is in [from, to). */
+static inline Vertex DegreeDistRange(StoreDegreeDist *dd, unsigned int l, Vertex from, Vertex to){
+  Vertex count = 0;
+  for(Vertex d = from; d < to && d <= dd->top[l-1]; d++) count += dd->hist[l-1][d];
+  return count;
+}
+
+/* Inputs: the degrees. */
+static void degree_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS; j++)
+    CHANGE_STAT[j] = DegreeDistCount(dd, 1, INPUT_PARAM[j]);
+}
+
+/* Inputs: (degree, level) pairs. */
+static void degree_by_attr_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS; j++)
+    CHANGE_STAT[j] = DegreeDistCount(dd, INPUT_PARAM[2*j+1], INPUT_PARAM[2*j]);
+}
+
+/* Inputs: (from, to) pairs. */
+static void degrange_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS; j++)
+    CHANGE_STAT[j] = DegreeDistRange(dd, 1, INPUT_PARAM[2*j], INPUT_PARAM[2*j+1]);
+}
+
+/* Inputs: (from, to, level) triples. */
+static void degrange_by_attr_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS; j++){
+    unsigned int l = INPUT_PARAM[3*j+2];
+    CHANGE_STAT[j] = l <= dd->nlevels ? DegreeDistRange(dd, l, INPUT_PARAM[3*j], INPUT_PARAM[3*j+1]) : 0;
+  }
+}
+
+static void concurrent_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  CHANGE_STAT[0] = dd->nnodes[0] - DegreeDistCount(dd, 1, 0) - DegreeDistCount(dd, 1, 1);
+}
+
+/* Inputs: the levels. */
+static void concurrent_by_attr_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS; j++){
+    unsigned int l = INPUT_PARAM[j];
+    CHANGE_STAT[j] = l <= dd->nlevels ? dd->nnodes[l-1] - DegreeDistCount(dd, l, 0) - DegreeDistCount(dd, l, 1) : 0;
+  }
+}
+
+static void isolates_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  CHANGE_STAT[0] = DegreeDistCount(dd, 1, 0);
+}
+
+/* Sum over vertices of level l of exp(decay)*(1-(1-exp(-decay))^degree). */
+static inline double DegreeDistGW(StoreDegreeDist *dd, unsigned int l, double decay){
+  double oneexpd = 1.0-exp(-decay), s = 0;
+  for(Vertex d = 1; d <= dd->top[l-1]; d++)
+    s += dd->hist[l-1][d] * (1-pow(oneexpd, d));
+  return exp(decay) * s;
+}
+
+/* Inputs: the decay. */
+static void gwdegree_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  CHANGE_STAT[0] = DegreeDistGW(dd, 1, INPUT_PARAM[0]);
+}
+
+/* Inputs: the decay; statistic j is for level j+1. */
+static void gwdegree_by_attr_summ(ModelTerm *mtp, StoreDegreeDist *dd){
+  for(unsigned int j = 0; j < N_CHANGE_STATS && j < dd->nlevels; j++)
+    CHANGE_STAT[j] = DegreeDistGW(dd, j+1, INPUT_PARAM[0]);
+}
+
+#define DEGREEDIST_S_FN(name, summ, mode, first, last, attr)            \
+  S_CHANGESTAT_FN(s_ ## name){                                          \
+    DegreeDistSumm(mtp, nwp, summ, mode, first, last, attr);            \
+  }
+
+DEGREEDIST_S_FN(degree, degree_summ, DEGREEDIST_BOTH, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(idegree, degree_summ, DEGREEDIST_IN, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(odegree, degree_summ, DEGREEDIST_OUT, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(b1degree, degree_summ, DEGREEDIST_BOTH, 1, BIPARTITE, NULL)
+DEGREEDIST_S_FN(b2degree, degree_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, NULL)
+
+DEGREEDIST_S_FN(degree_by_attr, degree_by_attr_summ, DEGREEDIST_BOTH, 1, N_NODES, INPUT_PARAM + 2*N_CHANGE_STATS)
+DEGREEDIST_S_FN(idegree_by_attr, degree_by_attr_summ, DEGREEDIST_IN, 1, N_NODES, INPUT_PARAM + 2*N_CHANGE_STATS)
+DEGREEDIST_S_FN(odegree_by_attr, degree_by_attr_summ, DEGREEDIST_OUT, 1, N_NODES, INPUT_PARAM + 2*N_CHANGE_STATS)
+DEGREEDIST_S_FN(b1degree_by_attr, degree_by_attr_summ, DEGREEDIST_BOTH, 1, BIPARTITE, INPUT_PARAM + 2*N_CHANGE_STATS)
+DEGREEDIST_S_FN(b2degree_by_attr, degree_by_attr_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, INPUT_PARAM + 2*N_CHANGE_STATS)
+
+DEGREEDIST_S_FN(degrange, degrange_summ, DEGREEDIST_BOTH, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(idegrange, degrange_summ, DEGREEDIST_IN, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(odegrange, degrange_summ, DEGREEDIST_OUT, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(b1degrange, degrange_summ, DEGREEDIST_BOTH, 1, BIPARTITE, NULL)
+DEGREEDIST_S_FN(b2degrange, degrange_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, NULL)
+
+DEGREEDIST_S_FN(degrange_by_attr, degrange_by_attr_summ, DEGREEDIST_BOTH, 1, N_NODES, INPUT_PARAM + 3*N_CHANGE_STATS)
+DEGREEDIST_S_FN(idegrange_by_attr, degrange_by_attr_summ, DEGREEDIST_IN, 1, N_NODES, INPUT_PARAM + 3*N_CHANGE_STATS)
+DEGREEDIST_S_FN(odegrange_by_attr, degrange_by_attr_summ, DEGREEDIST_OUT, 1, N_NODES, INPUT_PARAM + 3*N_CHANGE_STATS)
+DEGREEDIST_S_FN(b1degrange_by_attr, degrange_by_attr_summ, DEGREEDIST_BOTH, 1, BIPARTITE, INPUT_PARAM + 3*N_CHANGE_STATS)
+DEGREEDIST_S_FN(b2degrange_by_attr, degrange_by_attr_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, INPUT_PARAM + 3*N_CHANGE_STATS)
+
+DEGREEDIST_S_FN(concurrent, concurrent_summ, DEGREEDIST_BOTH, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(b1concurrent, concurrent_summ, DEGREEDIST_BOTH, 1, BIPARTITE, NULL)
+DEGREEDIST_S_FN(b2concurrent, concurrent_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, NULL)
+
+DEGREEDIST_S_FN(concurrent_by_attr, concurrent_by_attr_summ, DEGREEDIST_BOTH, 1, N_NODES, INPUT_PARAM + N_CHANGE_STATS)
+DEGREEDIST_S_FN(b1concurrent_by_attr, concurrent_by_attr_summ, DEGREEDIST_BOTH, 1, BIPARTITE, INPUT_PARAM + N_CHANGE_STATS)
+DEGREEDIST_S_FN(b2concurrent_by_attr, concurrent_by_attr_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, INPUT_PARAM + N_CHANGE_STATS)
+
+DEGREEDIST_S_FN(gwdegree, gwdegree_summ, DEGREEDIST_BOTH, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(gwidegree, gwdegree_summ, DEGREEDIST_IN, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(gwodegree, gwdegree_summ, DEGREEDIST_OUT, 1, N_NODES, NULL)
+DEGREEDIST_S_FN(gwb1degree, gwdegree_summ, DEGREEDIST_BOTH, 1, BIPARTITE, NULL)
+DEGREEDIST_S_FN(gwb2degree, gwdegree_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, NULL)
+
+DEGREEDIST_S_FN(gwdegree_by_attr, gwdegree_by_attr_summ, DEGREEDIST_BOTH, 1, N_NODES, INPUT_PARAM + 1)
+DEGREEDIST_S_FN(gwidegree_by_attr, gwdegree_by_attr_summ, DEGREEDIST_IN, 1, N_NODES, INPUT_PARAM + 1)
+DEGREEDIST_S_FN(gwodegree_by_attr, gwdegree_by_attr_summ, DEGREEDIST_OUT, 1, N_NODES, INPUT_PARAM + 1)
+DEGREEDIST_S_FN(gwb1degree_by_attr, gwdegree_by_attr_summ, DEGREEDIST_BOTH, 1, BIPARTITE, INPUT_PARAM + 1)
+DEGREEDIST_S_FN(gwb2degree_by_attr, gwdegree_by_attr_summ, DEGREEDIST_BOTH, BIPARTITE+1, N_NODES, INPUT_PARAM + 1)
+
+DEGREEDIST_S_FN(isolates, isolates_summ, DEGREEDIST_BOTH, 1, N_NODES, NULL)
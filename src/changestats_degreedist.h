@@ -0,0 +1,53 @@
+/*  File src/changestats_degreedist.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _CHANGESTATS_DEGREEDIST_H_
+#define _CHANGESTATS_DEGREEDIST_H_
+
+#include "ergm_edgetree.h"
+#include "ergm_changestat.h"
+#include "ergm_storage.h"
+
+/* Which edges count toward the degree of a vertex. */
+#define DEGREEDIST_OUT 1
+#define DEGREEDIST_IN 2
+#define DEGREEDIST_BOTH (DEGREEDIST_OUT | DEGREEDIST_IN)
+
+/* A degree distribution, as tabulated by DegreeDistInitialize().
+
+   Only vertices first..last are counted. attr[v-first] is the level
+   (1..nlevels) of vertex v, or attr is NULL if there is only one
+   level. nnodes[l-1] is the number of vertices with level l, and
+   hist[l-1][d] the number of them with degree d, for d up to the
+   highest such degree, top[l-1].
+*/
+typedef struct StoreDegreeDiststruct {
+  unsigned int mode;
+  Vertex first, last;
+  unsigned int nlevels;
+  double *attr;
+  Vertex *nnodes;
+  Vertex **hist;
+  Vertex *top;
+} StoreDegreeDist;
+
+#define DEGREEDIST_LEVEL(dd, v) ((dd)->attr ? (unsigned int)(dd)->attr[(v)-(dd)->first] : 1)
+#define DEGREEDIST_DEG(dd, v, nwp) ((((dd)->mode & DEGREEDIST_OUT) ? (nwp)->outdegree[v] : 0) + \
+                                    (((dd)->mode & DEGREEDIST_IN) ? (nwp)->indegree[v] : 0))
+
+/* The number of vertices with level l and degree d. */
+static inline Vertex DegreeDistCount(StoreDegreeDist *dd, unsigned int l, Vertex d){
+  if(l < 1 || l > dd->nlevels || d > dd->top[l-1]) return 0;
+  return dd->hist[l-1][d];
+}
+
+void DegreeDistInitialize(StoreDegreeDist *dd, unsigned int mode, Vertex first, Vertex last, double *attr, Network *nwp);
+void DegreeDistDestroy(StoreDegreeDist *dd);
+
+#endif // _CHANGESTATS_DEGREEDIST_H_
@@ -0,0 +1,367 @@
+/*  File src/changestats_geodist.c in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#include "changestats_geodist.h"
+
+/* Maintain the matrix of geodesic distances, truncated at maxdist,
+   between all ordered pairs of vertices, repairing it incrementally
+   after each toggle rather than rerunning breadth-first search.
+
+   For each source s, adding an edge t->h can only shorten distances,
+   and only if d(s,t)+1 < d(s,h); in that case, a breadth-first search
+   from h visits exactly the vertices whose distances decrease.
+
+   Removing an edge t->h can only lengthen distances, and only if it
+   lies on a shortest path from s, i.e., d(s,h) == d(s,t)+1. Then,
+   the affected vertices are those all of whose shortest paths from s
+   pass through t->h. They are found level by level starting from h:
+   a vertex is affected if it has no unaffected predecessor one step
+   closer to s. Their new distances are then computed from their
+   unaffected predecessors by a breadth-first search seeded at
+   multiple levels.
+
+   For undirected networks, each edge is treated as a pair of arcs. */
+
+#define GD_K (gd->maxdist)
+#define GD_BEYOND (gd->maxdist+1)
+
+/* Distance from the current source, taking into account pending
+   changes (for insertion). */
+#define GD_ND(v) (gd->seen[(v)]==gd->stamp ? gd->nd[(v)] : row[(v)])
+#define GD_SET(v, x) {                                          \
+    if(gd->seen[(v)]!=gd->stamp){                               \
+      gd->seen[(v)]=gd->stamp;                                  \
+      gd->changed[(*nchanged)++]=(v);                           \
+    }                                                           \
+    gd->nd[(v)]=(x);                                            \
+  }
+
+static inline void GeoDistNextStamp(StoreGeoDist *gd){
+  if(++gd->stamp == 0){ // Wrapped around: reset the stamps.
+    memset(gd->seen, 0, (gd->n+1)*sizeof(unsigned int));
+    memset(gd->affected, 0, (gd->n+1)*sizeof(unsigned int));
+    memset(gd->done, 0, (gd->n+1)*sizeof(unsigned int));
+    gd->stamp = 1;
+  }
+}
+
+static inline void GeoDistPend(StoreGeoDist *gd, Vertex s, Vertex v, unsigned int oldd, unsigned int newd){
+  if(gd->npend == gd->maxpend){
+    gd->maxpend = MAX(gd->maxpend, gd->n)*2;
+    gd->pend_s = Realloc(gd->pend_s, gd->maxpend, Vertex);
+    gd->pend_v = Realloc(gd->pend_v, gd->maxpend, Vertex);
+    gd->pend_d = Realloc(gd->pend_d, gd->maxpend, unsigned char);
+  }
+  gd->pend_s[gd->npend] = s;
+  gd->pend_v[gd->npend] = v;
+  gd->pend_d[gd->npend] = newd;
+  gd->npend++;
+  gd->delta[oldd]--;
+  gd->delta[newd]++;
+}
+
+/* Bounded breadth-first search from s, overwriting s's row. */
+static void GeoDistBFS(Vertex s, StoreGeoDist *gd, Network *nwp){
+  unsigned char *row = GEODIST_ROW(gd, s);
+  Vertex qh = 0, qt = 0;
+
+  memset(row+1, GD_BEYOND, gd->n);
+  row[s] = 0;
+  gd->queue[qt++] = s;
+  while(qh < qt){
+    Vertex u = gd->queue[qh++];
+    unsigned int du = row[u];
+    if(du >= GD_K) continue;
+    EXEC_THROUGH_OUTEDGES(u, e, w, {
+        if(row[w] == GD_BEYOND){
+          row[w] = du+1;
+          gd->queue[qt++] = w;
+        }
+      });
+  }
+}
+
+/* Propagate the shortening of distances from s (whose current row is
+   row) due to the addition of arc a->b. */
+static void GeoDistInsertArc(Vertex a, Vertex b, const unsigned char *row, StoreGeoDist *gd, Network *nwp, Vertex *nchanged){
+  unsigned int da = GD_ND(a);
+  if(da >= GD_K || da+1 >= GD_ND(b)) return;
+
+  Vertex qh = 0, qt = 0;
+  GD_SET(b, da+1);
+  gd->queue[qt++] = b;
+  while(qh < qt){
+    Vertex u = gd->queue[qh++];
+    unsigned int du = GD_ND(u);
+    if(du >= GD_K) continue;
+    EXEC_THROUGH_OUTEDGES(u, e, w, {
+        if(du+1 < GD_ND(w)){
+          GD_SET(w, du+1);
+          gd->queue[qt++] = w;
+        }
+      });
+  }
+}
+
+/* Find the vertices whose distance from s (whose current row is row)
+   increases due to the removal of arc a->b, which is known to lie on
+   a shortest path from s, and compute their new distances. Returns
+   the number of affected vertices, which are placed in gd->order with
+   their new distances in gd->nd. */
+static Vertex GeoDistDeleteArc(Vertex a, Vertex b, const unsigned char *row, StoreGeoDist *gd, Network *nwp){
+  Vertex qh = 0, qt = 0, na = 0;
+
+  /* Phase 1: Identify affected vertices in the order of their
+     distance from s, so that all affected vertices on one level are
+     known before the next level is examined. */
+  gd->seen[b] = gd->stamp;
+  gd->queue[qt++] = b;
+  while(qh < qt){
+    Vertex v = gd->queue[qh++];
+    unsigned int dv = row[v];
+    Rboolean supported = FALSE;
+    EXEC_THROUGH_INEDGES(v, e, u, {
+        if(!supported && row[u]+1u == dv && gd->affected[u] != gd->stamp && !(u==a && v==b))
+          supported = TRUE;
+      });
+    if(supported) continue;
+
+    gd->affected[v] = gd->stamp;
+    gd->order[na++] = v;
+    if(dv < GD_K)
+      EXEC_THROUGH_OUTEDGES(v, e, w, {
+          if(row[w] == dv+1 && gd->seen[w] != gd->stamp){
+            gd->seen[w] = gd->stamp;
+            gd->queue[qt++] = w;
+          }
+        });
+  }
+
+  /* Phase 2: Initial distance estimates from unaffected predecessors. */
+  memset(gd->bucket, 0, (GD_BEYOND+2)*sizeof(Vertex));
+  for(Vertex i = 0; i < na; i++){
+    Vertex v = gd->order[i];
+    unsigned int t = GD_BEYOND;
+    EXEC_THROUGH_INEDGES(v, e, u, {
+        if(gd->affected[u] != gd->stamp && !(u==a && v==b) && row[u]+1u < t)
+          t = row[u]+1;
+      });
+    gd->nd[v] = t;
+    gd->bucket[t+1]++;
+  }
+
+  /* Counting sort of the affected vertices by their initial estimates
+     into gd->queue (which is no longer needed). */
+  for(unsigned int k = 1; k <= GD_BEYOND+1; k++) gd->bucket[k] += gd->bucket[k-1];
+  for(Vertex i = 0; i < na; i++){
+    Vertex v = gd->order[i];
+    gd->queue[gd->bucket[gd->nd[v]]++] = v;
+  }
+
+  /* Phase 3: Breadth-first search seeded at multiple levels: merge
+     the sorted seeds with the FIFO queue of relaxed vertices, whose
+     distances are nondecreasing. Seeds whose estimates had since been
+     lowered will also be in the FIFO queue, so they are simply
+     skipped once done. */
+  Vertex si = 0, fh = 0, ft = 0;
+  while(si < na || fh < ft){
+    Vertex v;
+    if(fh < ft && (si >= na || gd->nd[gd->fifo[fh]] <= gd->nd[gd->queue[si]])) v = gd->fifo[fh++];
+    else v = gd->queue[si++];
+    if(gd->done[v] == gd->stamp) continue;
+    gd->done[v] = gd->stamp;
+
+    unsigned int dv = gd->nd[v];
+    if(dv >= GD_K) continue;
+    EXEC_THROUGH_OUTEDGES(v, e, w, {
+        if(gd->affected[w] == gd->stamp && gd->done[w] != gd->stamp && dv+1 < gd->nd[w]){
+          gd->nd[w] = dv+1;
+          gd->fifo[ft++] = w;
+        }
+      });
+  }
+
+  return na;
+}
+
+/* Compute the change in the distance histogram that would result from
+   toggling (tail, head), saving the changes to individual distances
+   so that they can be committed by GeoDistCommit(). Returns a pointer
+   to the change in the histogram. */
+double *GeoDistPropose(Vertex tail, Vertex head, StoreGeoDist *gd, Network *nwp, Rboolean edgestate){
+  if(!DIRECTED && tail > head){
+    Vertex tmp = tail; tail = head; head = tmp;
+  }
+#ifdef _OPENMP
+#pragma omp critical(GeoDistPropose)
+#endif
+  if(!gd->pend_valid || gd->pend_t != tail || gd->pend_h != head){
+    memset(gd->delta, 0, (GD_BEYOND+1)*sizeof(double));
+    gd->npend = 0;
+
+    for(Vertex s = 1; s <= gd->n; s++){
+      const unsigned char *row = GEODIST_ROW(gd, s);
+      unsigned int dt = row[tail], dh = row[head];
+
+      if(edgestate){
+        Vertex a, b;
+        if(dh <= GD_K && dh == dt+1){ a = tail; b = head; }
+        else if(!DIRECTED && dt <= GD_K && dt == dh+1){ a = head; b = tail; }
+        else continue;
+
+        GeoDistNextStamp(gd);
+        Vertex na = GeoDistDeleteArc(a, b, row, gd, nwp);
+        for(Vertex i = 0; i < na; i++){
+          Vertex v = gd->order[i];
+          if(gd->nd[v] != row[v]) GeoDistPend(gd, s, v, row[v], gd->nd[v]);
+        }
+      }else{
+        if(!(dt < GD_K && dt+1 < dh) && !(!DIRECTED && dh < GD_K && dh+1 < dt)) continue;
+
+        GeoDistNextStamp(gd);
+        Vertex nchanged = 0;
+        GeoDistInsertArc(tail, head, row, gd, nwp, &nchanged);
+        if(!DIRECTED) GeoDistInsertArc(head, tail, row, gd, nwp, &nchanged);
+        for(Vertex i = 0; i < nchanged; i++){
+          Vertex v = gd->changed[i];
+          if(gd->nd[v] != row[v]) GeoDistPend(gd, s, v, row[v], gd->nd[v]);
+        }
+      }
+    }
+
+    gd->pend_t = tail;
+    gd->pend_h = head;
+    gd->pend_valid = TRUE;
+  }
+
+  return gd->delta;
+}
+
+static inline void GeoDistCommit(StoreGeoDist *gd){
+  for(Dyad i = 0; i < gd->npend; i++)
+    GEODIST_ROW(gd, gd->pend_s[i])[gd->pend_v[i]] = gd->pend_d[i];
+  for(unsigned int k = 1; k <= GD_BEYOND; k++)
+    gd->hist[k] += gd->delta[k];
+  gd->npend = 0;
+  gd->pend_valid = FALSE;
+}
+
+/*****************
+ Auxiliary: _geodist_net
+
+ Maintains a StoreGeoDist with distances truncated at IINPUT_PARAM[0].
+*****************/
+
+I_CHANGESTAT_FN(i__geodist_net){
+  ALLOC_AUX_STORAGE(1, StoreGeoDist, gd);
+  Vertex n = gd->n = N_NODES;
+  unsigned int K = gd->maxdist = IINPUT_PARAM[0];
+
+  gd->d = Calloc((Dyad)n*n, unsigned char);
+  gd->hist = Calloc(K+2, double);
+  gd->delta = Calloc(K+2, double);
+  gd->seen = Calloc(n+1, unsigned int);
+  gd->affected = Calloc(n+1, unsigned int);
+  gd->done = Calloc(n+1, unsigned int);
+  gd->nd = Calloc(n+1, unsigned char);
+  gd->queue = Calloc(n, Vertex);
+  gd->changed = Calloc(n, Vertex);
+  gd->order = Calloc(n, Vertex);
+  gd->fifo = Calloc(n, Vertex);
+  gd->bucket = Calloc(K+3, Vertex);
+  gd->stamp = 0;
+
+  for(Vertex s = 1; s <= n; s++){
+    GeoDistBFS(s, gd, nwp);
+    const unsigned char *row = GEODIST_ROW(gd, s);
+    for(Vertex v = 1; v <= n; v++)
+      if(v != s) gd->hist[row[v]]++;
+  }
+}
+
+U_CHANGESTAT_FN(u__geodist_net){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  GeoDistPropose(tail, head, gd, nwp, edgestate);
+  GeoDistCommit(gd);
+}
+
+F_CHANGESTAT_FN(f__geodist_net){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  Free(gd->d);
+  Free(gd->hist);
+  Free(gd->delta);
+  Free(gd->seen);
+  Free(gd->affected);
+  Free(gd->done);
+  Free(gd->nd);
+  Free(gd->queue);
+  Free(gd->changed);
+  Free(gd->order);
+  Free(gd->fifo);
+  Free(gd->bucket);
+  Free(gd->pend_s);
+  Free(gd->pend_v);
+  Free(gd->pend_d);
+}
+
+/*****************
+ changestat: geodist
+
+ Number of pairs of vertices at each of the geodesic distances in
+ IINPUT_PARAM. Ordered pairs for directed networks, unordered for
+ undirected.
+*****************/
+
+C_CHANGESTAT_FN(c_geodist){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  double *delta = GeoDistPropose(tail, head, gd, nwp, edgestate);
+  double mult = DIRECTED ? 1 : 0.5;
+
+  for(unsigned int i = 0; i < N_CHANGE_STATS; i++)
+    CHANGE_STAT[i] = delta[IINPUT_PARAM[i]] * mult;
+}
+
+S_CHANGESTAT_FN(s_geodist){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  double mult = DIRECTED ? 1 : 0.5;
+
+  for(unsigned int i = 0; i < N_CHANGE_STATS; i++)
+    CHANGE_STAT[i] = gd->hist[IINPUT_PARAM[i]] * mult;
+}
+
+/*****************
+ changestat: reachable
+
+ Number of pairs of vertices within each of the geodesic distances in
+ IINPUT_PARAM of each other. Ordered pairs for directed networks,
+ unordered for undirected.
+*****************/
+
+C_CHANGESTAT_FN(c_reachable){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  double *delta = GeoDistPropose(tail, head, gd, nwp, edgestate);
+  double mult = DIRECTED ? 1 : 0.5;
+
+  for(unsigned int i = 0; i < N_CHANGE_STATS; i++){
+    double change = 0;
+    for(int k = 1; k <= IINPUT_PARAM[i]; k++) change += delta[k];
+    CHANGE_STAT[i] = change * mult;
+  }
+}
+
+S_CHANGESTAT_FN(s_reachable){
+  GET_AUX_STORAGE(StoreGeoDist, gd);
+  double mult = DIRECTED ? 1 : 0.5;
+
+  for(unsigned int i = 0; i < N_CHANGE_STATS; i++){
+    double stat = 0;
+    for(int k = 1; k <= IINPUT_PARAM[i]; k++) stat += gd->hist[k];
+    CHANGE_STAT[i] = stat * mult;
+  }
+}
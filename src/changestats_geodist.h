@@ -0,0 +1,55 @@
+/*  File src/changestats_geodist.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _CHANGESTATS_GEODIST_H_
+#define _CHANGESTATS_GEODIST_H_
+
+#include "ergm_edgetree.h"
+#include "ergm_changestat.h"
+#include "ergm_storage.h"
+
+/* Storage for the bounded geodesic distance auxiliary.
+
+   d is an n*n matrix of unsigned char, row s (0-indexed) containing
+   the geodesic distances from vertex s+1 to every vertex, with
+   distances greater than maxdist (including infinity) coded as
+   maxdist+1. hist[k] for k=1..maxdist+1 is the number of ordered
+   pairs of distinct vertices at distance k.
+
+   Because computing the change statistic requires the same work as
+   updating the distances, the change in distances implied by the
+   most recently evaluated toggle is kept in the pending list, so that
+   the u_ function can commit it without recomputing.
+*/
+typedef struct StoreGeoDiststruct {
+  unsigned int maxdist;
+  Vertex n;
+  unsigned char *d;
+  double *hist;
+
+  /* Scratch space. */
+  unsigned int stamp;
+  unsigned int *seen, *affected, *done;
+  unsigned char *nd;
+  Vertex *queue, *changed, *order, *fifo, *bucket;
+
+  /* The effect of toggling (pend_t, pend_h) if pend_valid. */
+  Rboolean pend_valid;
+  Vertex pend_t, pend_h;
+  Dyad npend, maxpend;
+  Vertex *pend_s, *pend_v;
+  unsigned char *pend_d;
+  double *delta;
+} StoreGeoDist;
+
+#define GEODIST_ROW(gd, s) ((gd)->d + (Dyad)((s)-1)*(gd)->n - 1)
+
+double *GeoDistPropose(Vertex tail, Vertex head, StoreGeoDist *gd, Network *nwp, Rboolean edgestate);
+
+#endif // _CHANGESTATS_GEODIST_H_
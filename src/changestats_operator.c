@@ -11,16 +11,19 @@
 #include "ergm_changestat_auxnet.h"
 #include "ergm_changestats_operator.h"
 #include "ergm_util.h"
+#include "changestats_sum.h"
 
 /* passthrough(formula) */
 
 I_CHANGESTAT_FN(i_passthrough_term){
-  // No need to allocate it: we are only storing a pointer to a model.
-  Model *m = STORAGE = ModelInitialize(getListElement(mtp->R, "submodel"), mtp->ext_state,  nwp, FALSE);
+  // No need to allocate it: we are only storing a pointer to a model,
+  // possibly shared with other terms via .submodel().
+  Model *m = STORAGE = N_AUX ? AUX_STORAGE_NUM(0) : ModelInitialize(getListElement(mtp->R, "submodel"), mtp->ext_state,  nwp, FALSE);
 
   SELECT_C_OR_D_BASED_ON_SUBMODEL(m);
   DELETE_IF_UNUSED_IN_SUBMODEL(x_func, m);
   DELETE_IF_UNUSED_IN_SUBMODEL(z_func, m);
+  if(N_AUX && mtp->x_func) ModelXMemoUse(m);
 }
 
 D_CHANGESTAT_FN(d_passthrough_term){
@@ -39,7 +42,13 @@ C_CHANGESTAT_FN(c_passthrough_term){
   memcpy(CHANGE_STAT, m->workspace, N_CHANGE_STATS*sizeof(double));
 }
 
-X_CHANGESTAT_PROPAGATE_FN(x_passthrough_term, GET_STORAGE(Model, m), m)
+X_CHANGESTAT_FN(x_passthrough_term){
+  GET_STORAGE(Model, m);
+
+  PROPAGATE_X_SIGNAL_SHARED(nwp, m);
+
+  memcpy(CHANGE_STAT, m->workspace, N_CHANGE_STATS*sizeof(double));
+}
 
 Z_CHANGESTAT_FN(z_passthrough_term){
   GET_STORAGE(Model, m);
@@ -51,7 +60,8 @@ Z_CHANGESTAT_FN(z_passthrough_term){
 F_CHANGESTAT_FN(f_passthrough_term){
   GET_STORAGE(Model, m);
 
-  ModelDestroy(nwp, m);
+  // A shared submodel is destroyed by its auxiliary.
+  if(!N_AUX) ModelDestroy(nwp, m);
 
   STORAGE = NULL;
 }
@@ -60,7 +70,27 @@ F_CHANGESTAT_FN(f_passthrough_term){
 
 I_CHANGESTAT_FN(i__submodel_term){
   // No need to allocate it: we are only storing a pointer to a model.
-  AUX_STORAGE = ModelInitialize(getListElement(mtp->R, "submodel"), NULL,  nwp, FALSE);
+  Model *m = AUX_STORAGE = ModelInitialize(getListElement(mtp->R, "submodel"), NULL,  nwp, FALSE);
+  // The terms using the submodel can then share its change statistics.
+  ModelMemoEnable(m);
+  // They can also share the change statistics from a signal, which
+  // must reach the submodel's terms only once.
+  DELETE_IF_UNUSED_IN_SUBMODEL(x_func, m);
+  if(mtp->x_func) ModelXMemoEnable(m);
+}
+
+U_CHANGESTAT_FN(u__submodel_term){
+  GET_AUX_STORAGE(Model, m);
+  ModelMemoReset(m);
+  ModelXMemoReset(m);
+}
+
+X_CHANGESTAT_FN(x__submodel_term){
+  GET_AUX_STORAGE(Model, m);
+
+  // Propagates the signal if none of the terms using the submodel
+  // has done so yet.
+  PROPAGATE_X_SIGNAL_SHARED(nwp, m);
 }
 
 F_CHANGESTAT_FN(f__submodel_term){
@@ -156,14 +186,17 @@ I_CHANGESTAT_FN(i__submodel_and_summary_term){
   memcpy(storage->stats, m->workspace, m->n_stats*sizeof(double));
 
   DELETE_IF_UNUSED_IN_SUBMODEL(z_func, m);
+  ModelMemoEnable(m);
 }
 
 U_CHANGESTAT_FN(u__submodel_and_summary_term){
   GET_AUX_STORAGE(StoreModelAndStats, storage);
   Model *m = storage->m;
 
+  // Usually reuses the change statistics of the accepted proposal.
   ChangeStats1(tail, head, nwp, m, edgestate);
   addonto(storage->stats, m->workspace, m->n_stats);
+  ModelMemoReset(m);
 }
 
 F_CHANGESTAT_FN(f__submodel_and_summary_term){
@@ -176,85 +209,84 @@ F_CHANGESTAT_FN(f__submodel_and_summary_term){
 
 // Sum: Take a weighted sum of the models' statistics.
 
+typedef struct {
+  unsigned int nms;
+  Model **ms;
+  SumMap *maps;
+} StoreSum;
+
 I_CHANGESTAT_FN(i_Sum){
   /*
     inputs expected:
     1: number of models (nms)
     1: total length of all weight matrices (tml)
     tml: a list of mapping matrices in row-major order
+
+    If the submodels can be shared, they are requested as .submodel()
+    auxiliaries, one per submodel.
   */
-  
+
   double *inputs = INPUT_PARAM; 
   unsigned int nms = *(inputs++);
-  unsigned int tml = *(inputs++);
-  inputs+=tml; // Jump to start of model specifications.
-  
-  ALLOC_STORAGE(nms, Model*, ms);
+  inputs++; //  Skip total length of weight matrices.
+  double *wts = inputs;
+
+  ALLOC_STORAGE(1, StoreSum, sto);
+  sto->nms = nms;
+  sto->ms = Calloc(nms, Model*);
+  sto->maps = Calloc(nms, SumMap);
 
   SEXP submodels = getListElement(mtp->R, "submodels");
   for(unsigned int i=0; i<nms; i++){
-    ms[i] = ModelInitialize(VECTOR_ELT(submodels, i), isNULL(mtp->ext_state) ? NULL : VECTOR_ELT(mtp->ext_state,i), nwp, FALSE);
+    Model *m = sto->ms[i] = N_AUX ? AUX_STORAGE_NUM(i) : ModelInitialize(VECTOR_ELT(submodels, i), isNULL(mtp->ext_state) ? NULL : VECTOR_ELT(mtp->ext_state,i), nwp, FALSE);
+    SumMapInitialize(sto->maps + i, wts, N_CHANGE_STATS, m->n_stats);
+    wts += N_CHANGE_STATS*m->n_stats;
   }
-  DELETE_IF_UNUSED_IN_SUBMODELS(x_func, ms, nms);
-  DELETE_IF_UNUSED_IN_SUBMODELS(z_func, ms, nms);
+  DELETE_IF_UNUSED_IN_SUBMODELS(x_func, sto->ms, nms);
+  DELETE_IF_UNUSED_IN_SUBMODELS(z_func, sto->ms, nms);
+  if(N_AUX && mtp->x_func)
+    for(unsigned int i=0; i<nms; i++) ModelXMemoUse(sto->ms[i]);
 }
 
 C_CHANGESTAT_FN(c_Sum){
-  double *inputs = INPUT_PARAM; 
-  GET_STORAGE(Model*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSum, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    Model *m = ms[i];
+  for(unsigned int i=0; i<sto->nms; i++){
+    Model *m = sto->ms[i];
     ChangeStats1(tail, head, nwp, m, edgestate);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 Z_CHANGESTAT_FN(z_Sum){
-  double *inputs = INPUT_PARAM;
-  GET_STORAGE(Model*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSum, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    Model *m = ms[i];
+  for(unsigned int i=0; i<sto->nms; i++){
+    Model *m = sto->ms[i];
     ZStats(nwp, m, FALSE);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 X_CHANGESTAT_FN(x_Sum){
-  double *inputs = INPUT_PARAM;
-  GET_STORAGE(Model*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSum, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    Model *m = ms[i];
-    PROPAGATE_X_SIGNAL_INTO(nwp, m, m->workspace);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+  for(unsigned int i=0; i<sto->nms; i++){
+    Model *m = sto->ms[i];
+    PROPAGATE_X_SIGNAL_SHARED(nwp, m);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 F_CHANGESTAT_FN(f_Sum){
-  double *inputs = INPUT_PARAM; 
-  GET_STORAGE(Model*, ms);
-  unsigned int nms = *(inputs++);
+  GET_STORAGE(StoreSum, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    ModelDestroy(nwp, ms[i]);
+  for(unsigned int i=0; i<sto->nms; i++){
+    if(!N_AUX) ModelDestroy(nwp, sto->ms[i]);
+    SumMapDestroy(sto->maps + i);
   }
+  Free(sto->ms);
+  Free(sto->maps);
 }
 
 
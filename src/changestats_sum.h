@@ -0,0 +1,91 @@
+/*  File src/changestats_sum.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _CHANGESTATS_SUM_H_
+#define _CHANGESTATS_SUM_H_
+
+#include <R.h>
+
+/* The matrix mapping a submodel's statistics onto those of a Sum()
+   term, stored by submodel statistic so that only the nonzero ones
+   need to be visited. If at most half of its elements are nonzero, it
+   is stored in the compressed sparse row format (cols and vals, with
+   row j in positions rowstart[j] to rowstart[j+1]-1), and if they are
+   all 1, vals is omitted; otherwise, it is stored densely in wts. */
+typedef struct {
+  unsigned int n_stats, n_out;
+  double *wts;
+  unsigned int *rowstart, *cols;
+  double *vals;
+} SumMap;
+
+/* Initialize from the n_out x n_stats matrix w in row-major order. */
+static inline void SumMapInitialize(SumMap *sm, const double *w, unsigned int n_out, unsigned int n_stats){
+  sm->n_stats = n_stats;
+  sm->n_out = n_out;
+  sm->wts = sm->vals = NULL;
+  sm->rowstart = sm->cols = NULL;
+
+  unsigned int nnz = 0;
+  Rboolean indicator = TRUE;
+  for(unsigned int i = 0; i < n_out*n_stats; i++)
+    if(w[i] != 0){
+      nnz++;
+      if(w[i] != 1) indicator = FALSE;
+    }
+
+  if(2*nnz > n_out*n_stats){
+    sm->wts = Calloc(n_stats*n_out, double);
+    for(unsigned int j = 0; j < n_stats; j++)
+      for(unsigned int k = 0; k < n_out; k++)
+        sm->wts[j*n_out + k] = w[k*n_stats + j];
+    return;
+  }
+
+  sm->rowstart = Calloc(n_stats + 1, unsigned int);
+  sm->cols = Calloc(nnz ? nnz : 1, unsigned int);
+  if(!indicator) sm->vals = Calloc(nnz ? nnz : 1, double);
+  unsigned int p = 0;
+  for(unsigned int j = 0; j < n_stats; j++){
+    sm->rowstart[j] = p;
+    for(unsigned int k = 0; k < n_out; k++)
+      if(w[k*n_stats + j] != 0){
+        sm->cols[p] = k;
+        if(sm->vals) sm->vals[p] = w[k*n_stats + j];
+        p++;
+      }
+  }
+  sm->rowstart[n_stats] = p;
+}
+
+static inline void SumMapDestroy(SumMap *sm){
+  Free(sm->wts);
+  Free(sm->rowstart);
+  Free(sm->cols);
+  Free(sm->vals);
+}
+
+/* Add the mapping of the submodel statistics x onto out. */
+static inline void SumMapAddOnto(double *out, const double *x, const SumMap *sm){
+  for(unsigned int j = 0; j < sm->n_stats; j++){
+    double xj = x[j];
+    if(xj == 0) continue;
+
+    if(sm->wts){
+      const double *w = sm->wts + j*sm->n_out;
+      for(unsigned int k = 0; k < sm->n_out; k++) out[k] += xj * w[k];
+    }else if(sm->vals){
+      for(unsigned int p = sm->rowstart[j]; p < sm->rowstart[j+1]; p++) out[sm->cols[p]] += xj * sm->vals[p];
+    }else{
+      for(unsigned int p = sm->rowstart[j]; p < sm->rowstart[j+1]; p++) out[sm->cols[p]] += xj;
+    }
+  }
+}
+
+#endif // _CHANGESTATS_SUM_H_
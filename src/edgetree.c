@@ -99,6 +99,12 @@ Network *NetworkInitializeD(double *tails, double *heads, Edge nedges,
  void NetworkDestroy
 *******************/
 void NetworkDestroy(Network *nwp) {
+  if(nwp->eindex){
+    UnsrtELDestroy(nwp->eindex->el);
+    Free(nwp->eindex->pos);
+    Free(nwp->eindex->fenwick);
+    Free(nwp->eindex);
+  }
   Free(nwp->on_edge_change);
   Free(nwp->on_edge_change_payload);
   Free(nwp->indegree);
@@ -135,9 +141,143 @@ Network *NetworkCopy(Network *src){
 
   EDGECOUNT(dest) = EDGECOUNT(src);
 
+  if(src->eindex){
+    NetworkEdgeIndex *sidx = src->eindex, *didx = dest->eindex = Calloc(1, NetworkEdgeIndex);
+    didx->el = UnsrtELInitialize(sidx->el->nedges, sidx->el->tails+1, sidx->el->heads+1, TRUE);
+    didx->pos = Calloc(maxedges, Edge);
+    memcpy(didx->pos, sidx->pos, maxedges*sizeof(Edge));
+    didx->fenwick = Calloc(nnodes+1, Edge);
+    memcpy(didx->fenwick, sidx->fenwick, (nnodes+1)*sizeof(Edge));
+  }
+
   return dest;
 }
 
+/*****************
+ Fenwick tree utilities
+
+ fenwick[v] holds the sum of outdegree[] over the (v & -v) vertices
+ ending at v. FenwickAdd() adds delta to outdegree[v]'s contribution,
+ and FenwickTopBit() returns the largest power of 2 not exceeding n,
+ from which a descent through the tree starts.
+*****************/
+static inline void FenwickAdd(Edge *fenwick, Vertex n, Vertex v, int delta){
+  for(; v <= n; v += v & -v) fenwick[v] += delta;
+}
+
+static inline Vertex FenwickTopBit(Vertex n){
+  Vertex step = 1;
+  while(step <= n/2) step <<= 1;
+  return step;
+}
+
+/*****************
+ void NetworkEdgeIndexEnable
+
+ Build the NetworkEdgeIndex of nwp (see ergm_edgetree.h) if it does
+ not already have one. From then on, it is maintained by
+ AddEdgeToTrees() and DeleteEdgeFromTrees(), making GetRandEdge()
+ constant-time and FindithEdge() and FindithNonedge() logarithmic in
+ the number of vertices, at the cost of a little extra work per
+ toggle. It is freed along with the network.
+*****************/
+void NetworkEdgeIndexEnable(Network *nwp){
+  if(nwp->eindex) return;
+  NetworkEdgeIndex *idx = nwp->eindex = Calloc(1, NetworkEdgeIndex);
+  Vertex n = nwp->nnodes;
+
+  idx->el = UnsrtELInitialize(0, NULL, NULL, FALSE);
+  idx->pos = Calloc(nwp->maxedges, Edge);
+  for(Vertex t = 1; t <= n; t++)
+    for(Edge e = EdgetreeMinimum(nwp->outedges, t); nwp->outedges[e].value != 0; e = EdgetreeSuccessor(nwp->outedges, e)){
+      UnsrtELInsert(t, nwp->outedges[e].value, idx->el);
+      idx->pos[e] = idx->el->nedges;
+    }
+
+  idx->fenwick = Calloc(n+1, Edge);
+  for(Vertex v = 1; v <= n; v++){
+    idx->fenwick[v] += nwp->outdegree[v];
+    Vertex w = v + (v & -v);
+    if(w <= n) idx->fenwick[w] += idx->fenwick[v];
+  }
+}
+
+/*****************
+ void NetworkCompact
+
+ Rebuild the edgetrees of nwp, so that the tree of each vertex is
+ balanced and its non-root TreeNodes occupy a contiguous block of
+ the array, in preorder, with no gaps between blocks. The arrays are
+ also shrunk if they are much larger than needed (e.g., after the
+ network had been much denser). Takes time linear in the number of
+ edges and vertices; no TreeNode indices obtained before the call
+ remain valid after it.
+*****************/
+
+/* Place vals[lo..hi] as a balanced subtree rooted at edges[slot],
+   taking the TreeNodes for its descendants from *next onwards. */
+static Edge EdgetreePlaceBalanced(TreeNode *edges, Edge *pos, Vertex *vals, Edge *vpos,
+                                  Edge lo, Edge hi, Edge slot, Edge parent, Edge *next){
+  Edge mid = lo + (hi-lo)/2;
+  TreeNode *ptr = edges+slot;
+  ptr->value = vals[mid];
+  ptr->parent = parent;
+  if(pos) pos[slot] = vpos[mid];
+  ptr->left = mid > lo ? EdgetreePlaceBalanced(edges, pos, vals, vpos, lo, mid-1, (*next)++, slot, next) : 0;
+  ptr->right = mid < hi ? EdgetreePlaceBalanced(edges, pos, vals, vpos, mid+1, hi, (*next)++, slot, next) : 0;
+  return slot;
+}
+
+static TreeNode *EdgetreeCompact(TreeNode *edges, Edge **pos, Vertex nnodes, Vertex *degree,
+                                 Edge newmax, Edge *last_edge){
+  TreeNode *newedges = Calloc(newmax, TreeNode);
+  Edge *newpos = *pos ? Calloc(newmax, Edge) : NULL;
+  Vertex maxdeg = 0;
+  for(Vertex a = 1; a <= nnodes; a++) maxdeg = MAX(maxdeg, degree[a]);
+  Vertex *vals = Calloc(maxdeg, Vertex);
+  Edge *vpos = *pos ? Calloc(maxdeg, Edge) : NULL;
+
+  Edge next = nnodes + 1;
+  for(Vertex a = 1; a <= nnodes; a++){
+    if(degree[a] == 0) continue;
+    Edge k = 0;
+    for(Edge e = EdgetreeMinimum(edges, a); e != 0; e = EdgetreeSuccessor(edges, e)){
+      vals[k] = edges[e].value;
+      if(vpos) vpos[k] = (*pos)[e];
+      k++;
+    }
+    EdgetreePlaceBalanced(newedges, newpos, vals, vpos, 0, k-1, a, 0, &next);
+  }
+  *last_edge = next - 1;
+
+  Free(vals);
+  if(vpos) Free(vpos);
+  if(*pos){
+    Free(*pos);
+    *pos = newpos;
+  }
+  Free(edges);
+  return newedges;
+}
+
+void NetworkCompact(Network *nwp){
+  Vertex nnodes = nwp->nnodes;
+  // Keep some room to grow, but not more than was there already.
+  Edge newmax = MIN(nwp->maxedges, nnodes + 2 + 2*MAX(EDGECOUNT(nwp), 1));
+  Edge *nopos = NULL;
+
+  nwp->outedges = EdgetreeCompact(nwp->outedges, nwp->eindex ? &nwp->eindex->pos : &nopos,
+                                  nnodes, nwp->outdegree, newmax, &nwp->last_outedge);
+  nwp->inedges = EdgetreeCompact(nwp->inedges, &nopos,
+                                 nnodes, nwp->indegree, newmax, &nwp->last_inedge);
+  nwp->maxedges = newmax;
+}
+
+#define DISPATCH_Network Network
+#define DISPATCH_TreeNode TreeNode
+#define DISPATCH_NetworkGetEdgetreeStats NetworkGetEdgetreeStats
+#include "edgetree.c.template.do_not_include_directly.h"
+
 /* *** don't forget, edges are now given by tails -> heads, and as
        such, the function definitions now require tails to be passed
        in before heads */
@@ -220,11 +360,17 @@ void AddEdgeToTrees(Vertex tail, Vertex head, Network *nwp){
 #endif // DEBUG
   for(unsigned int i = 0; i < nwp->n_on_edge_change; i++) nwp->on_edge_change[i](tail, head, nwp->on_edge_change_payload[i], nwp, FALSE);
 
-  AddHalfedgeToTree(tail, head, nwp->outedges, &(nwp->last_outedge));
+  Edge e = AddHalfedgeToTree(tail, head, nwp->outedges, &(nwp->last_outedge));
   AddHalfedgeToTree(head, tail, nwp->inedges, &(nwp->last_inedge));
   ++nwp->outdegree[tail];
   ++nwp->indegree[head];
   ++EDGECOUNT(nwp);
+  if(nwp->eindex){
+    NetworkEdgeIndex *idx = nwp->eindex;
+    UnsrtELInsert(tail, head, idx->el);
+    idx->pos[e] = idx->el->nedges;
+    FenwickAdd(idx->fenwick, nwp->nnodes, tail, +1);
+  }
   CheckEdgetreeFull(nwp);
 }
 
@@ -248,11 +394,20 @@ int DeleteEdgeFromTrees(Vertex tail, Vertex head, Network *nwp){
     if(nwp->n_on_edge_change){
       for(unsigned int i = 0; i < nwp->n_on_edge_change; i++) nwp->on_edge_change[i](tail, head, nwp->on_edge_change_payload[i], nwp, TRUE);
     }
-    DeleteHalfedgeFromTreeAt(tail, head, nwp->outedges,&(nwp->last_outedge), zth);
-    DeleteHalfedgeFromTreeAt(head, tail, nwp->inedges, &(nwp->last_inedge), zht);
+    NetworkEdgeIndex *idx = nwp->eindex;
+    Edge k = idx ? idx->pos[zth] : 0;
+    DeleteHalfedgeFromTreeAt(tail, head, nwp->outedges,&(nwp->last_outedge), zth, idx ? idx->pos : NULL);
+    DeleteHalfedgeFromTreeAt(head, tail, nwp->inedges, &(nwp->last_inedge), zht, NULL);
     --nwp->outdegree[tail];
     --nwp->indegree[head];
     --EDGECOUNT(nwp);
+    if(idx){
+      // The last edge in the list takes the deleted edge's place.
+      UnsrtEL *el = idx->el;
+      if(k != el->nedges) idx->pos[EdgetreeSearch(el->tails[el->nedges], el->heads[el->nedges], nwp->outedges)] = k;
+      UnsrtELDeleteAt(k, el);
+      FenwickAdd(idx->fenwick, nwp->nnodes, tail, -1);
+    }
     return 1;
   }
   return 0;
@@ -371,7 +526,9 @@ Edge DesignMissing (Vertex a, Vertex b, Network *mnwp) {
   update the values of tail and head appropriately.  Return
   1 if successful, 0 otherwise.  
   Note that i is numbered from 1, not 0.  Thus, the maximum possible
-  value of i is EDGECOUNT(nwp).
+  value of i is EDGECOUNT(nwp).  Edges are ordered by tail, then head.
+  If nwp has a NetworkEdgeIndex, the tail is found in O(log n) time;
+  otherwise, the tails are scanned in order.
 ******************/
 
 /* *** don't forget tail->head, so this function now accepts tail before head */
@@ -385,17 +542,35 @@ int FindithEdge (Vertex *tail, Vertex *head, Edge i, Network *nwp) {
 
   if (i > EDGECOUNT(nwp) || i<=0)
     return 0;
-  while (i > nwp->outdegree[taili]) {
-    i -= nwp->outdegree[taili];
-    taili++;
+  if(nwp->eindex){
+    // Descend the Fenwick tree to the first tail at which the
+    // cumulative number of edges reaches i.
+    Edge *fenwick = nwp->eindex->fenwick;
+    Vertex t = 0;
+    for(Vertex step = FenwickTopBit(nwp->nnodes); step; step >>= 1)
+      if(t + step <= nwp->nnodes && fenwick[t + step] < i){
+        t += step;
+        i -= fenwick[t];
+      }
+    taili = t + 1;
+  }else{
+    while (i > nwp->outdegree[taili]) {
+      i -= nwp->outdegree[taili];
+      taili++;
+    }
   }
 
-  /* TODO: This could be speeded up by a factor of 3 or more by starting
-     the search from the tree maximum rather than minimum (left over) i > outdegree[taili]. */
-
-  e=EdgetreeMinimum(nwp->outedges,taili);
-  while (i-- > 1) {
-    e=EdgetreeSuccessor(nwp->outedges, e);
+  // Walk from whichever end of the tail's tree is closer.
+  if(i <= (nwp->outdegree[taili]+1)/2){
+    e=EdgetreeMinimum(nwp->outedges,taili);
+    while (i-- > 1) {
+      e=EdgetreeSuccessor(nwp->outedges, e);
+    }
+  }else{
+    e=EdgetreeMaximum(nwp->outedges,taili);
+    while (i++ < nwp->outdegree[taili]) {
+      e=EdgetreePredecessor(nwp->outedges, e);
+    }
   }
   *tail = taili;
   *head = nwp->outedges[e].value;
@@ -407,12 +582,17 @@ int FindithEdge (Vertex *tail, Vertex *head, Edge i, Network *nwp) {
 
   Select an edge in the Network *nwp at random and update the values
   of tail and head appropriately. Return 1 if successful, 0 otherwise.
+  If nwp has a NetworkEdgeIndex, this takes constant time.
 ******************/
 
 /* *** don't forget tail->head, so this function now accepts tail before head */
 
 int GetRandEdge(Vertex *tail, Vertex *head, Network *nwp) {
   if(EDGECOUNT(nwp)==0) return(0);
+  if(nwp->eindex){
+    UnsrtELGetRand(tail, head, nwp->eindex->el);
+    return 1;
+  }
   // FIXME: The constant maxEattempts needs to be tuned.
   const unsigned int maxEattempts=10;
   unsigned int Eattempts = nwp->last_outedge/EDGECOUNT(nwp);
@@ -449,11 +629,20 @@ int GetRandEdge(Vertex *tail, Vertex *head, Network *nwp) {
   update the values of tail and head appropriately.  Return
   1 if successful, 0 otherwise.  
   Note that i is numbered from 1, not 0.  Thus, the maximum possible
-  value of i is (ndyads - EDGECOUNT(nwp)).
+  value of i is (ndyads - EDGECOUNT(nwp)).  As with FindithEdge(), the
+  tail is found in O(log n) time if nwp has a NetworkEdgeIndex.
 ******************/
 
   /* *** don't forget,  tail -> head */
 
+/* The number of dyads whose tails are in 1..t. */
+static inline Dyad FindithNonedgeDyads(Vertex t, Network *nwp){
+  Dyad n = nwp->nnodes;
+  if(nwp->bipartite) return (Dyad)MIN(t, nwp->bipartite) * (n - nwp->bipartite);
+  else if(nwp->directed_flag) return (Dyad)t * (n - 1);
+  else return (Dyad)t * n - (Dyad)t * (t + 1) / 2;
+}
+
 int FindithNonedge (Vertex *tail, Vertex *head, Dyad i, Network *nwp) {
   Vertex taili=1;
   Edge e;
@@ -466,11 +655,27 @@ int FindithNonedge (Vertex *tail, Vertex *head, Dyad i, Network *nwp) {
   /* TODO: This could be speeded up by a factor of 3 or more by starting
      the search from the tail n rather than tail 1 if i > ndyads/2. */
 
-  Vertex nnt;
-  while (i > (nnt = nwp->nnodes - (nwp->bipartite ? nwp->bipartite : (nwp->directed_flag?1:taili))
-	      - nwp->outdegree[taili])) {   // nnt is the number of nonties incident on taili. Note that when network is undirected, tail<head.
-    i -= nnt;
-    taili++;
+  if(nwp->eindex){
+    // As in FindithEdge(), but the number of nonties of tails 1..t
+    // is the number of dyads they can send, less their outdegrees.
+    Edge *fenwick = nwp->eindex->fenwick;
+    Vertex n = nwp->nnodes, t = 0;
+    for(Vertex step = FenwickTopBit(n); step; step >>= 1)
+      if(t + step <= n){
+        Dyad nnt = FindithNonedgeDyads(t + step, nwp) - FindithNonedgeDyads(t, nwp) - fenwick[t + step];
+        if(nnt < i){
+          t += step;
+          i -= nnt;
+        }
+      }
+    taili = t + 1;
+  }else{
+    Vertex nnt;
+    while (i > (nnt = nwp->nnodes - (nwp->bipartite ? nwp->bipartite : (nwp->directed_flag?1:taili))
+                - nwp->outdegree[taili])) {   // nnt is the number of nonties incident on taili. Note that when network is undirected, tail<head.
+      i -= nnt;
+      taili++;
+    }
   }
 
   // Now, our tail is taili.
@@ -0,0 +1,79 @@
+/*  File src/edgetree.c.template.do_not_include_directly.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+
+/* Routines shared by Network and WtNetwork, which only use the
+   fields their TreeNodes have in common. The including file must
+   define DISPATCH_Network, DISPATCH_TreeNode, and
+   DISPATCH_NetworkGetEdgetreeStats. */
+
+/*****************
+ void DISPATCH_NetworkGetEdgetreeStats
+
+ Diagnostic routine that reports the layout of the outedges array of
+ nwp in *stats (see EdgetreeStats). Takes time linear in the
+ number of edges and vertices.
+*****************/
+void DISPATCH_NetworkGetEdgetreeStats(DISPATCH_Network *nwp, EdgetreeStats *stats){
+  Vertex nnodes = nwp->nnodes;
+  DISPATCH_TreeNode *edges = nwp->outedges;
+  Edge span = nwp->last_outedge;
+
+  stats->span = span;
+  stats->capacity = nwp->maxedges;
+  stats->empty = span ? 1 - (double) EDGECOUNT(nwp) / span : 0;
+
+  // Depths and roots of the non-root TreeNodes, found by climbing
+  // to the nearest TreeNode whose depth is already known (roots have
+  // depth 0), so that each is climbed through only once.
+  Edge *depth = Calloc(span+1, Edge), *root = Calloc(span+1, Edge);
+  Edge *lo = Calloc(nnodes+1, Edge), *hi = Calloc(nnodes+1, Edge);
+  double depthsum = 0;
+  for(Edge e = nnodes+1; e <= span; e++){
+    if(edges[e].value == 0) continue;
+    Edge x = e, k = 0;
+    while(x > nnodes && depth[x] == 0){
+      x = edges[x].parent;
+      k++;
+    }
+    Edge d = x > nnodes ? depth[x] : 0, r = x > nnodes ? root[x] : x;
+    for(x = e; k; k--, x = edges[x].parent){
+      depth[x] = d + k;
+      root[x] = r;
+    }
+    depthsum += depth[e];
+    if(lo[r] == 0 || e < lo[r]) lo[r] = e;
+    if(e > hi[r]) hi[r] = e;
+  }
+
+  // Numbering the nodes of a balanced tree breadth-first from 1, the
+  // ith node has depth floor(log2(i)).
+  double mindepthsum = 0;
+  Vertex nmulti = 0, ncontig = 0;
+  for(Vertex a = 1; a <= nnodes; a++){
+    Vertex deg = nwp->outdegree[a];
+    for(Vertex i = 2, lg = 0; i <= deg; i++){
+      if((i & (i-1)) == 0) lg++;
+      mindepthsum += lg;
+    }
+    if(deg >= 2){
+      nmulti++;
+      if(hi[a] - lo[a] + 1 == deg - 1) ncontig++;
+    }
+  }
+
+  stats->depth = EDGECOUNT(nwp) ? depthsum / EDGECOUNT(nwp) : 0;
+  stats->mindepth = EDGECOUNT(nwp) ? mindepthsum / EDGECOUNT(nwp) : 0;
+  stats->contiguous = nmulti ? (double) ncontig / nmulti : 1;
+
+  Free(depth);
+  Free(root);
+  Free(lo);
+  Free(hi);
+}
@@ -27,10 +27,12 @@ static inline void RelocateHalfedge(Edge from, Edge to, TreeNode *edges){
 
  Delete the TreeNode with value b from the tree rooted at edges[a].
  Return 0 if no such TreeNode exists, 1 otherwise.  Also update the
- value of *last_edge appropriately.
+ value of *last_edge appropriately.  If pos is not NULL, it is an
+ array indexed by TreeNode (see NetworkEdgeIndex) whose elements
+ follow the values as they are moved between TreeNodes.
 *****************/
 static inline void DeleteHalfedgeFromTreeAt(Vertex a, Vertex b, TreeNode *edges,
-                                            Edge *last_edge, Edge z){
+                                            Edge *last_edge, Edge z, Edge *pos){
   Edge x, root=(Edge)a;
   TreeNode *xptr, *zptr, *ptr;
 
@@ -46,6 +48,7 @@ static inline void DeleteHalfedgeFromTreeAt(Vertex a, Vertex b, TreeNode *edges,
     else
       z=EdgetreePredecessor(edges, z);  
     zptr->value = (ptr=edges+z)->value;
+    if(pos) pos[zptr-edges] = pos[z];
     zptr=ptr;
   }
   /* Set x to the child of z (there is at most one). */
@@ -55,13 +58,16 @@ static inline void DeleteHalfedgeFromTreeAt(Vertex a, Vertex b, TreeNode *edges,
   if (z == root) {
     zptr->value = (xptr=edges+x)->value;
     if (x != 0) {
+      if(pos) pos[z] = pos[x];
       if ((zptr->left=xptr->left) != 0)
 	(edges+zptr->left)->parent = z;
       if ((zptr->right=xptr->right) != 0)
 	(edges+zptr->right)->parent = z;
       zptr=edges+(z=x);
-    }  else 
+    }  else {
+      if(pos) pos[z] = 0;
       return;
+    }
   } else {
     if (x != 0)
       (xptr=edges+x)->parent = zptr->parent;
@@ -73,6 +79,10 @@ static inline void DeleteHalfedgeFromTreeAt(Vertex a, Vertex b, TreeNode *edges,
   /* Clear z node, update *last_edge if necessary. */
   zptr->value=0;
   if(z!=root){
+    if(pos){
+      pos[z] = pos[*last_edge];
+      pos[*last_edge] = 0;
+    }
     RelocateHalfedge(*last_edge,z,edges);
     (*last_edge)--;
   }
@@ -96,20 +106,27 @@ static inline void CheckEdgetreeFull (Network *nwp) {
     nwp->outedges = (TreeNode *) Realloc(nwp->outedges, newmax, TreeNode);
     memset(nwp->outedges+nwp->maxedges, 0,
 	   sizeof(TreeNode) * (newmax-nwp->maxedges));
+    if(nwp->eindex){
+      nwp->eindex->pos = Realloc(nwp->eindex->pos, newmax, Edge);
+      memset(nwp->eindex->pos+nwp->maxedges, 0,
+             sizeof(Edge) * (newmax-nwp->maxedges));
+    }
     nwp->maxedges = newmax;
   }
 }
 
 /*****************
- void AddHalfedgeToTree:  Only called by AddEdgeToTrees
+ Edge AddHalfedgeToTree:  Only called by AddEdgeToTrees
+
+ Returns the index of the TreeNode in which b was stored.
 *****************/
-static inline void AddHalfedgeToTree (Vertex a, Vertex b, TreeNode *edges, Edge *last_edge){
+static inline Edge AddHalfedgeToTree (Vertex a, Vertex b, TreeNode *edges, Edge *last_edge){
   TreeNode *eptr = edges+a, *newnode;
   Edge e;
 
   if (eptr->value==0) { /* This is the first edge for vertex a. */
     eptr->value=b;
-    return;
+    return a;
   }
   (newnode = edges + (++*last_edge))->value=b;  
   newnode->left = newnode->right = 0;
@@ -120,4 +137,5 @@ static inline void AddHalfedgeToTree (Vertex a, Vertex b, TreeNode *edges, Edge
     eptr->left=*last_edge; 
   else
     eptr->right=*last_edge;
+  return *last_edge;
 }
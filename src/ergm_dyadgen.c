@@ -111,28 +111,41 @@ DyadGen *DyadGenInitializeR(SEXP pR, void *any_nwp, Rboolean el){
   DyadGenType type = asInteger(getListElement(dgR, "type"));
 
   void *track = el ? any_nwp : NULL;
+  DyadGen *gen = NULL;
 
   switch(type){
   case RandDyadGen:
   case WtRandDyadGen:
-    return DyadGenInitialize(type, any_nwp, track);
+    gen = DyadGenInitialize(type, any_nwp, track);
+    break;
   case RLEBDM1DGen:
   case WtRLEBDM1DGen:
     // RLEBDM1D's unpacking function expects a double **.
     {
       double *tmp = REAL(getListElement(dgR, "dyads"));
-      return DyadGenInitialize(type, &tmp, track);
+      gen = DyadGenInitialize(type, &tmp, track);
     }
+    break;
   case EdgeListGen:
   case WtEdgeListGen:
     // RLEBDM1D's unpacking function expects an int **.
     {
       int *tmp = INTEGER(getListElement(dgR, "dyads"));
-      return DyadGenInitialize(type, &tmp, track);
+      gen = DyadGenInitialize(type, &tmp, track);
     }
+    break;
   default:
     error("Undefined dyad generator type.");
   }
+
+  // If edges are to be drawn from the whole binary network and the
+  // proposal asks for it, index them.
+  SEXP eiR = getListElement(pR, "edge.index");
+  if(el && !gen->intersect && (type == RandDyadGen || type == RLEBDM1DGen || type == EdgeListGen) &&
+     length(eiR) && asLogical(eiR) == TRUE)
+    NetworkEdgeIndexEnable(gen->nwp.b);
+
+  return gen;
 }
 
 
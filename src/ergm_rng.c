@@ -0,0 +1,56 @@
+/*  File src/ergm_rng.c in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#include "ergm_rng.h"
+
+static inline uint64_t rotl(uint64_t x, int k){
+  return (x << k) | (x >> (64 - k));
+}
+
+ErgmRNG *ErgmRNGInitialize(ErgmRNGMode mode){
+  ErgmRNG *rng = Calloc(1, ErgmRNG);
+  rng->mode = mode;
+  rng->pos = ERGM_RNG_BUFSIZE; // Empty: fill on first draw.
+
+  if(mode == ERGM_RNG_FAST){
+    // Seed from R's generator, 32 bits at a time; the state must not
+    // be all zeros.
+    do{
+      for(unsigned int i = 0; i < 4; i++)
+        rng->s[i] = ((uint64_t)(unif_rand() * 4294967296.0) << 32) | (uint64_t)(unif_rand() * 4294967296.0);
+    }while(!(rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]));
+  }
+
+  return rng;
+}
+
+void ErgmRNGDestroy(ErgmRNG *rng){
+  Free(rng);
+}
+
+/* Refill the buffer using xoshiro256+, taking the top 53 bits of
+   each output and offsetting by half a unit so that the result lies
+   strictly between 0 and 1. */
+void ErgmRNGFill(ErgmRNG *rng){
+  uint64_t s0 = rng->s[0], s1 = rng->s[1], s2 = rng->s[2], s3 = rng->s[3];
+
+  for(unsigned int i = 0; i < ERGM_RNG_BUFSIZE; i++){
+    uint64_t x = s0 + s3, t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = rotl(s3, 45);
+    rng->buf[i] = ((double)(x >> 11) + 0.5) * 0x1.0p-53;
+  }
+
+  rng->s[0] = s0; rng->s[1] = s1; rng->s[2] = s2; rng->s[3] = s3;
+  rng->pos = 0;
+}
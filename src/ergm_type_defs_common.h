@@ -10,6 +10,8 @@
 #define PROP_PRINT Rprintf("  (%d, %d)  ", MHp->toggletail[i], MHp->togglehead[i])
 #define PROP_CHANGESTATS ChangeStats(MHp->ntoggles, MHp->toggletail, MHp->togglehead, nwp, m)
 #define PROP_COMMIT ToggleEdge(MHp->toggletail[i], MHp->togglehead[i], nwp)
+#define PROP_GIBBS (MHp->gibbs)
+#define PROP_NODESWAP (MHp->nodeswap[0])
 #define DISPATCH_ErgmState ErgmState
 #define DISPATCH_ErgmStateInit ErgmStateInit
 #define DISPATCH_Model Model
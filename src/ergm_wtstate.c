@@ -14,6 +14,14 @@ static WtErgmState **ergm_wtstate_array = NULL;
 static unsigned int ergm_wtstate_array_len = 0;
 static unsigned int ergm_wtstate_array_maxlen = 0;
 
+static void WtErgmStateRegister(WtErgmState *s){
+  if(ergm_wtstate_array_len == ergm_wtstate_array_maxlen){
+    ergm_wtstate_array_maxlen = MAX(1, ergm_wtstate_array_maxlen*2);
+    ergm_wtstate_array = Realloc(ergm_wtstate_array, ergm_wtstate_array_maxlen, WtErgmState*);
+  }
+  ergm_wtstate_array[ergm_wtstate_array_len++] = s;
+}
+
 WtErgmState *WtErgmStateInit(SEXP stateR,
                              unsigned int flags){
   WtErgmState *s = Calloc(1, WtErgmState);
@@ -28,6 +36,11 @@ WtErgmState *WtErgmStateInit(SEXP stateR,
   /* Form the network */
   s->nwp=Redgelist2WtNetwork(getListElement(stateR,"el"), flags & ERGM_STATE_EMPTY_NET);
 
+  /* Store the weights as compactly as the reference measure allows,
+     unless the initial network has values it does not. */
+  tmp = getListElement(getListElement(getListElement(stateR, "proposal"), "reference"), "wttype");
+  if(s->nwp && length(tmp)) WtNetworkSetWeightType(s->nwp, asInteger(tmp));
+
   /* Initialize the model */
   s->m=NULL;
   tmp = getListElement(stateR, "model");
@@ -41,15 +54,37 @@ WtErgmState *WtErgmStateInit(SEXP stateR,
   if(!(flags & ERGM_STATE_NO_INIT_PROP) && s->m && length(tmp = getListElement(stateR, "proposal"))) // Proposal also requires model's auxiliaries.
     s->MHp = WtMHProposalInitialize(tmp, s->nwp, s->m->termarray->aux_storage);
 
-  if(ergm_wtstate_array_len == ergm_wtstate_array_maxlen){
-    ergm_wtstate_array_maxlen = MAX(1, ergm_wtstate_array_maxlen*2);
-    ergm_wtstate_array = Realloc(ergm_wtstate_array, ergm_wtstate_array_maxlen, WtErgmState*);
-  }
-  ergm_wtstate_array[ergm_wtstate_array_len++] = s;
+  WtErgmStateRegister(s);
 
   return s;
 }
 
+/* Make an independent copy of s, whose network must not have changed
+   since it was initialized from its R state, since the copy's model
+   and proposal are initialized from the same R objects but on a copy
+   of the network rather than on one constructed from the edgelist
+   again. flags must be the same as those passed to
+   WtErgmStateInit(). */
+WtErgmState *WtErgmStateClone(WtErgmState *s,
+                              unsigned int flags){
+  WtErgmState *c = Calloc(1, WtErgmState);
+  SEXP tmp;
+
+  c->R = s->R;
+  c->stats = s->stats;
+  c->nwp = s->nwp ? WtNetworkCopy(s->nwp) : NULL;
+
+  if(s->m)
+    c->m = WtModelInitialize(getListElement(s->R, "model"), getListElement(s->R, "ext.state"), c->nwp, flags & ERGM_STATE_NO_INIT_S);
+
+  if(s->MHp && length(tmp = getListElement(s->R, "proposal")))
+    c->MHp = WtMHProposalInitialize(tmp, c->nwp, c->m->termarray->aux_storage);
+
+  WtErgmStateRegister(c);
+
+  return c;
+}
+
 SEXP WtErgmStateRSave(WtErgmState *s){
   SEXP startR = s->R;
 
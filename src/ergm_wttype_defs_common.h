@@ -10,6 +10,7 @@
 #define PROP_PRINT Rprintf("  (%d, %d) -> %f  ", MHp->toggletail[i], MHp->togglehead[i], MHp->toggleweight[i])
 #define PROP_CHANGESTATS WtChangeStats(MHp->ntoggles, MHp->toggletail, MHp->togglehead, MHp->toggleweight, nwp, m)
 #define PROP_COMMIT WtSetEdge(MHp->toggletail[i], MHp->togglehead[i], MHp->toggleweight[i], nwp)
+#define PROP_GIBBS (MHp->gibbs)
 #define DISPATCH_ErgmState WtErgmState
 #define DISPATCH_ErgmStateInit WtErgmStateInit
 #define DISPATCH_Model WtModel
@@ -117,3 +117,169 @@ void full_geodesic_distribution (int *edgelist, int *nnodes,
       ++geodist[dist[j]-1];
   }
 }
+
+/*************  FUNCTION full_geodesic_distribution_par
+ As full_geodesic_distribution, but geodist is a double vector (so
+ that networks with more than 46340 nodes do not overflow it), the
+ sources are partitioned among up to *nthreads threads (if compiled
+ with OpenMP), each with its own search buffers, and if *bitparallel
+ is nonzero, each thread runs 64 breadth-first searches at a time,
+ with one bit of a 64-bit word per source, switching between pushing
+ the frontier along out-edges and pulling it along in-edges of
+ not-yet-reached vertices, depending on which is expected to be
+ cheaper. */
+
+/* Convert the edgelist (sorted by tail) into compressed sparse row
+   form: the out-neighbors of u are adj[start[u-1]]..adj[start[u]-1]. */
+static void geodist_csr(int *edgelist, int n, int nedges, int *start, int *adj, Rboolean reverse){
+  int *pos = Calloc(n+1, int);
+  memset(start, 0, (n+1)*sizeof(int));
+  for(int j=0; j<nedges; j++) start[edgelist[2*j+reverse]]++;
+  for(int i=1; i<=n; i++) start[i] += start[i-1];
+  /* Now start[u] is one past the end of u's block, and start[u-1] is its beginning. */
+  memcpy(pos, start, (n+1)*sizeof(int));
+  for(int j=0; j<nedges; j++){
+    int u = edgelist[2*j+reverse];
+    adj[pos[u-1]++] = edgelist[2*j+!reverse];
+  }
+  Free(pos);
+}
+
+/* BFS from one source, tallying distances into geodist. */
+static void geodist_bfs1(int n, int *start, int *adj, int s, int *dist, int *Q, double *geodist){
+  int Qbottom=0, Qtop=0;
+  for(int i=1; i<=n; i++) dist[i] = n; /* Here, n means infinity */
+  dist[s] = 0;
+  Q[Qtop++] = s;
+  while(Qbottom<Qtop){
+    int u = Q[Qbottom++];
+    for(int j=start[u-1]; j<start[u]; j++){
+      int v = adj[j];
+      if(dist[v]==n){
+        dist[v] = dist[u]+1;
+        geodist[dist[v]-1]++;
+        Q[Qtop++] = v;
+      }
+    }
+  }
+}
+
+/* 64 simultaneous BFSs from sources s0..s0+ns-1. */
+static void geodist_bfs64(int n, int *start, int *adj, int *rstart, int *radj, int s0, int ns,
+                          uint64_t *seen, uint64_t *visit, uint64_t *next, double *geodist){
+  const uint64_t all = ns==64 ? ~(uint64_t)0 : (((uint64_t)1)<<ns)-1;
+  memset(seen, 0, (n+1)*sizeof(uint64_t));
+  memset(visit, 0, (n+1)*sizeof(uint64_t));
+  for(int i=0; i<ns; i++) seen[s0+i] = visit[s0+i] = ((uint64_t)1)<<i;
+
+  int nfrontier = ns, nunfinished = n;
+  for(int d=1; nfrontier; d++){
+    memset(next, 0, (n+1)*sizeof(uint64_t));
+    /* Pushing costs the frontier's out-degrees, pulling the unfinished
+       vertices' in-degrees, with an early exit; since neither is known
+       without a pass, use vertex counts as a proxy. */
+    if(nfrontier < nunfinished/8){ /* Top-down */
+      for(int v=1; v<=n; v++){
+        uint64_t vv = visit[v];
+        if(!vv) continue;
+        for(int j=start[v-1]; j<start[v]; j++){
+          int w = adj[j];
+          uint64_t D = vv & ~seen[w];
+          if(D){
+            next[w] |= D;
+            seen[w] |= D;
+          }
+        }
+      }
+    }else{ /* Bottom-up */
+      for(int w=1; w<=n; w++){
+        uint64_t need = all & ~seen[w];
+        if(!need) continue;
+        uint64_t got = 0;
+        for(int j=rstart[w-1]; j<rstart[w] && got!=need; j++)
+          got |= visit[radj[j]] & need;
+        next[w] = got;
+      }
+      for(int w=1; w<=n; w++) seen[w] |= next[w];
+    }
+
+    nfrontier = nunfinished = 0;
+    double reached = 0;
+    for(int w=1; w<=n; w++){
+      if(next[w]){
+        nfrontier++;
+        reached += __builtin_popcountll(next[w]);
+      }
+      if(seen[w]!=all) nunfinished++;
+    }
+    geodist[d-1] += reached;
+
+    uint64_t *tmp = visit; visit = next; next = tmp;
+  }
+}
+
+void full_geodesic_distribution_par(int *edgelist, int *nnodes,
+                                    int *nodelist, int *nedges,
+                                    double *geodist, int *nthreads, int *bitparallel){
+  int n = *nnodes, m = *nedges;
+  int *start = Calloc(n+1, int), *adj = Calloc(m, int);
+  int *rstart = NULL, *radj = NULL;
+  geodist_csr(edgelist, n, m, start, adj, FALSE);
+  if(*bitparallel){
+    rstart = Calloc(n+1, int);
+    radj = Calloc(m, int);
+    geodist_csr(edgelist, n, m, rstart, radj, TRUE);
+  }
+
+  for(int i=0; i<n; i++) geodist[i] = 0;
+  int nblocks = *bitparallel ? (n+63)/64 : n;
+
+#ifdef _OPENMP
+  int nt = *nthreads > 0 ? *nthreads : omp_get_num_procs();
+#pragma omp parallel num_threads(nt)
+#endif
+  {
+    /* Per-thread buffers and histogram. */
+    double *mygeodist = Calloc(n, double);
+    uint64_t *seen = NULL, *visit = NULL, *next = NULL;
+    int *dist = NULL, *Q = NULL;
+    if(*bitparallel){
+      seen = Calloc(n+1, uint64_t);
+      visit = Calloc(n+1, uint64_t);
+      next = Calloc(n+1, uint64_t);
+    }else{
+      dist = Calloc(n+1, int);
+      Q = Calloc(n, int);
+    }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for(int b=0; b<nblocks; b++){
+      if(*bitparallel) geodist_bfs64(n, start, adj, rstart, radj, b*64+1, MIN(64, n-b*64), seen, visit, next, mygeodist);
+      else geodist_bfs1(n, start, adj, b+1, dist, Q, mygeodist);
+    }
+
+#ifdef _OPENMP
+#pragma omp critical(full_geodesic_distribution_par)
+#endif
+    for(int i=0; i<n; i++) geodist[i] += mygeodist[i];
+
+    Free(mygeodist);
+    if(*bitparallel){
+      Free(seen); Free(visit); Free(next);
+    }else{
+      Free(dist); Free(Q);
+    }
+  }
+
+  /* Whatever has not been reached is at infinity. */
+  double reached = 0;
+  for(int i=0; i<n-1; i++) reached += geodist[i];
+  geodist[n-1] = (double)n*(n-1) - reached;
+
+  Free(start); Free(adj);
+  if(*bitparallel){
+    Free(rstart); Free(radj);
+  }
+}
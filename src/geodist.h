@@ -11,6 +11,9 @@
 #define GEODIST_H
 
 #include "ergm_edgetree.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 void node_geodesics (int *edgelist, int *nnodes, int *nodelist,
                      int *nedges, int *nodecolor, int *dist, 
@@ -21,4 +24,8 @@ void full_geodesic_distribution (int *edgelist, int *nnodes,
 				 int *nodecolor, int *dist, int *Q,
 				 int *geodist);
 
+void full_geodesic_distribution_par(int *edgelist, int *nnodes,
+                                    int *nodelist, int *nedges,
+                                    double *geodist, int *nthreads, int *bitparallel);
+
 #endif
@@ -23,6 +23,7 @@
 
 /* .C calls */
 extern void full_geodesic_distribution(void *, void *, void *, void *, void *, void *, void *, void *);
+extern void full_geodesic_distribution_par(void *, void *, void *, void *, void *, void *, void *);
 extern void node_geodesics(void *, void *, void *, void *, void *, void *, void *, void *);
 
 /* .Call calls */
@@ -42,16 +43,19 @@ extern SEXP MPLE_wrapper(SEXP, SEXP, SEXP);
 extern SEXP network_stats_wrapper(SEXP);
 extern SEXP SAN_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP set_ergm_omp_terms(SEXP);
-extern SEXP test_weighted_population(SEXP, SEXP, SEXP);
+extern SEXP test_weighted_population(SEXP, SEXP, SEXP, SEXP);
 extern SEXP wt_network_stats_wrapper(SEXP);
 extern SEXP WtCD_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP WtGodfather_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP WtGodfatherStream_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP WtMCMC_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP WtMCMCMultiChain_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP WtMCMCPhase12(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP WtSAN_wrapper(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 
 static const R_CMethodDef CEntries[] = {
     {"full_geodesic_distribution", (DL_FUNC) &full_geodesic_distribution, 8},
+    {"full_geodesic_distribution_par", (DL_FUNC) &full_geodesic_distribution_par, 7},
     {"node_geodesics",             (DL_FUNC) &node_geodesics,             8},
     {NULL, NULL, 0}
 };
@@ -73,11 +77,13 @@ static const R_CallMethodDef CallEntries[] = {
     {"network_stats_wrapper",    (DL_FUNC) &network_stats_wrapper,     1},
     {"SAN_wrapper",              (DL_FUNC) &SAN_wrapper,               9},
     {"set_ergm_omp_terms",       (DL_FUNC) &set_ergm_omp_terms,        1},
-    {"test_weighted_population", (DL_FUNC) &test_weighted_population,  3},
+    {"test_weighted_population", (DL_FUNC) &test_weighted_population,  4},
     {"wt_network_stats_wrapper", (DL_FUNC) &wt_network_stats_wrapper,  1},
     {"WtCD_wrapper",             (DL_FUNC) &WtCD_wrapper,              5},
     {"WtGodfather_wrapper",      (DL_FUNC) &WtGodfather_wrapper,       6},
+    {"WtGodfatherStream_wrapper", (DL_FUNC) &WtGodfatherStream_wrapper, 6},
     {"WtMCMC_wrapper",           (DL_FUNC) &WtMCMC_wrapper,            7},
+    {"WtMCMCMultiChain_wrapper", (DL_FUNC) &WtMCMCMultiChain_wrapper,  7},
     {"WtMCMCPhase12",            (DL_FUNC) &WtMCMCPhase12,            10},
     {"WtSAN_wrapper",            (DL_FUNC) &WtSAN_wrapper,             9},
     {NULL, NULL, 0}
@@ -108,6 +108,8 @@ void ModelDestroy(Network *nwp, Model *m)
   Free(m->dstatarray);
   Free(m->termarray);
   Free(m->workspace_backup);
+  Free(m->memo);
+  Free(m->xmemo);
   Free(m);
 }
 
@@ -221,9 +223,19 @@ Model* ModelInitialize(SEXP mR, SEXP ext_state, Network *nwp, Rboolean noinit_s)
 	    searching for symbols associated with the object file with prefix
 	    sn, having the name fn.  Assuming that one is found, we're golden.*/ 
 	fn[0]='c';
+	/* If the term has a variant specialized to the network's
+	   directedness and to whether the term has inputs (see
+	   C_CHANGESTAT_FN_SPECIALIZED), use it instead. */
+	char *sfn = Calloc(strlen(fn)+5, char);
+	sprintf(sfn, "%s__%c%c", fn, nwp->directed_flag ? 'D' : 'U', thisterm->ninputparams ? 'A' : 'N');
 	thisterm->c_func = 
 	  (void (*)(Vertex, Vertex, ModelTerm*, Network*, Rboolean))
-	  R_FindSymbol(fn,sn,NULL);
+	  R_FindSymbol(sfn,sn,NULL);
+	Free(sfn);
+	if(thisterm->c_func==NULL)
+	  thisterm->c_func = 
+	    (void (*)(Vertex, Vertex, ModelTerm*, Network*, Rboolean))
+	    R_FindSymbol(fn,sn,NULL);
 
         fn[0]='d';
         thisterm->d_func =
@@ -376,8 +388,8 @@ void ChangeStats(unsigned int ntoggles, Vertex *tails, Vertex *heads,
   ChangeStats1
   A simplified version of WtChangeStats for exactly one change.
 */
-void ChangeStats1(Vertex tail, Vertex head,
-                  Network *nwp, Model *m, Rboolean edgestate){
+static inline void ChangeStats1Compute(Vertex tail, Vertex head,
+                                       Network *nwp, Model *m, Rboolean edgestate){
   memset(m->workspace, 0, m->n_stats*sizeof(double)); /* Zero all change stats. */
 
   /* Make a pass through terms with c_functions. */
@@ -394,6 +406,29 @@ void ChangeStats1(Vertex tail, Vertex head,
       });
 }
 
+void ChangeStats1(Vertex tail, Vertex head,
+                  Network *nwp, Model *m, Rboolean edgestate){
+  if(!m->memo){
+    ChangeStats1Compute(tail, head, nwp, m, edgestate);
+    return;
+  }
+
+  // The model may be shared by terms evaluated concurrently.
+#ifdef _OPENMP
+#pragma omp critical(ergm_model_memo)
+#endif
+  {
+    if(tail == m->memo_tail && head == m->memo_head){
+      memcpy(m->workspace, m->memo, m->n_stats*sizeof(double));
+    }else{
+      ChangeStats1Compute(tail, head, nwp, m, edgestate);
+      memcpy(m->memo, m->workspace, m->n_stats*sizeof(double));
+      m->memo_tail = tail;
+      m->memo_head = head;
+    }
+  }
+}
+
 /*
   ZStats
   Call baseline statistics calculation.
@@ -11,10 +11,20 @@
 #include "ergm_weighted_population.h"
 #include <Rinternals.h>
 
-SEXP test_weighted_population(SEXP weights, SEXP ndraws, SEXP type) {
+SEXP test_weighted_population(SEXP weights, SEXP ndraws, SEXP type, SEXP update) {
   GetRNGstate();  /* R function enabling uniform RNG */
   
-  WtPop *wtp = WtPopInitialize(length(weights), REAL(weights), CHAR(asChar(type))[0]);
+  WtPop *wtp;
+  if(asLogical(update)) {
+    /* start from equal weights and set the requested ones one at a time */
+    double *ones = Calloc(length(weights), double);
+    for(int i = 0; i < length(weights); i++) ones[i] = 1;
+    wtp = WtPopInitialize(length(weights), ones, CHAR(asChar(type))[0]);
+    Free(ones);
+    for(int i = 0; i < length(weights); i++) WtPopSetWt(i, REAL(weights)[i], wtp);
+  } else {
+    wtp = WtPopInitialize(length(weights), REAL(weights), CHAR(asChar(type))[0]);
+  }
   
   int n = asInteger(ndraws);
   
@@ -8,4 +8,163 @@
  *  Copyright 2003-2022 Statnet Commons
  */
 #include "wtMCMC.h"
+#include "ergm_util.h"
+
+/*********************
+ int GibbsBlockStep
+
+ Draws the values of the block of distinct dyads given by the proposed
+ toggles one at a time, each from its full conditional distribution
+ over the MHp->gibbs candidate values given the rest of the network,
+ adding the change statistics to networkstatistics. Returns whether
+ any value changed.
+*********************/
+static int GibbsBlockStep(WtMHProposal *MHp, WtNetwork *nwp, WtModel *m,
+                          double *eta, double *networkstatistics, int verbose){
+  unsigned int nvals = MHp->gibbs;
+  double *w = Calloc(nvals, double);
+  double *delta = Calloc((size_t) nvals*m->n_stats, double);
+  int changed = FALSE;
+
+  for(Edge i = 0; i < MHp->ntoggles; i++){
+    Vertex tail = MHp->toggletail[i], head = MHp->togglehead[i];
+    double oldwt = WtGetEdge(tail, head, nwp);
+
+    double maxw = R_NegInf;
+    for(unsigned int v = 0; v < nvals; v++){
+      double *d = delta + v*m->n_stats;
+      if(MHp->gibbs_values[v] == oldwt) memset(d, 0, m->n_stats*sizeof(double));
+      else{
+        WtChangeStats1(tail, head, MHp->gibbs_values[v], nwp, m, oldwt);
+        memcpy(d, m->workspace, m->n_stats*sizeof(double));
+      }
+
+      /* As in the MH step, a NaN log-weight (e.g., from 0*Inf) makes the
+         value impossible. */
+      w[v] = dotprod(eta, d, m->n_stats) + MHp->gibbs_logh[v];
+      if(ISNAN(w[v])) w[v] = R_NegInf;
+      maxw = fmax(maxw, w[v]);
+    }
+    if(maxw == R_NegInf) continue; // No possible value; leave the dyad as is.
+
+    double total = 0;
+    for(unsigned int v = 0; v < nvals; v++){
+      w[v] = exp(w[v] - maxw);
+      total += w[v];
+    }
+    double u = MH_UNIF_RAND()*total;
+    unsigned int v = 0;
+    while(v < nvals-1 && u >= w[v]){
+      u -= w[v];
+      v++;
+    }
+
+    if(verbose>=5){
+      Rprintf("Gibbs update of (%d, %d): %f -> %f.\n", tail, head, oldwt, MHp->gibbs_values[v]);
+    }
+
+    if(MHp->gibbs_values[v] != oldwt){
+      WtSetEdge(tail, head, MHp->gibbs_values[v], nwp);
+      addonto(networkstatistics, delta + v*m->n_stats, m->n_stats);
+      changed = TRUE;
+    }
+  }
+
+  Free(w);
+  Free(delta);
+  return changed;
+}
+
 #include "MCMC.c.template.do_not_include_directly.h"
+
+/*****************
+ SEXP WtMCMCMultiChain_wrapper
+
+ Runs a chain from each of the ergm_states in the list stateRs with
+ the same settings as WtMCMC_wrapper() and returns a list of their
+ outputs, each in the format of WtMCMC_wrapper(). A state identical
+ to the preceding one in the list is cloned from it rather than
+ constructed from R again.
+
+ When compiled with OpenMP, the chains run in parallel threads if
+ every chain's proposal is thread-safe (see ergm_wtMHproposal.h),
+ each drawing from its own generator (see ergm_rng.h), seeded from R's
+ in turn. Otherwise, and if the chains save networks or print
+ progress, which need R, they are run one at a time, exactly as
+ WtMCMC_wrapper() would run them. Unsuccessful proposals in the
+ threads are warned about once they have finished.
+*****************/
+SEXP WtMCMCMultiChain_wrapper(SEXP stateRs,
+                              // MCMC settings
+                              SEXP eta, SEXP samplesize,
+                              SEXP burnin, SEXP interval,
+                              SEXP maxedges,
+                              SEXP verbose){
+  GetRNGstate();  /* R function enabling uniform RNG */
+  int nchains = length(stateRs), n = asInteger(samplesize),
+    b = asInteger(burnin), itv = asInteger(interval), nmax = abs(asInteger(maxedges)),
+    save = asInteger(maxedges) < 0, serial = save || asInteger(verbose);
+
+  WtErgmState **s = Calloc(nchains, WtErgmState *);
+  double **samples = Calloc(nchains, double *);
+  MCMCStatus *status = Calloc(nchains, MCMCStatus);
+
+  const char *outn[] = {"status", "s", "state", "saved", ""};
+  SEXP outl = PROTECT(allocVector(VECSXP, nchains));
+
+  for(int i = 0; i < nchains; i++){
+    SEXP stateR = VECTOR_ELT(stateRs, i);
+    if(i && (stateR == VECTOR_ELT(stateRs, i-1) || R_compute_identical(stateR, VECTOR_ELT(stateRs, i-1), 16)))
+      s[i] = WtErgmStateClone(s[i-1], 0);
+    else s[i] = WtErgmStateInit(stateR, 0);
+    if(!s[i]->MHp || !s[i]->MHp->thread_safe) serial = TRUE;
+
+    SEXP chainl = mkNamed(VECSXP, outn);
+    SET_VECTOR_ELT(outl, i, chainl);
+
+    SEXP sample = allocVector(REALSXP, n*s[i]->m->n_stats);
+    SET_VECTOR_ELT(chainl, 1, sample);
+    samples[i] = REAL(sample);
+    memset(samples[i], 0, n*s[i]->m->n_stats*sizeof(double));
+    memcpy(samples[i], s[i]->stats, s[i]->m->n_stats*sizeof(double));
+
+    if(save){
+      s[i]->save = allocVector(VECSXP, n);
+      SET_VECTOR_ELT(chainl, 3, s[i]->save);
+    }else s[i]->save = NULL;
+  }
+
+  int v = serial ? asInteger(verbose) : 0;
+  if(!serial)
+    for(int i = 0; i < nchains; i++)
+      if(!s[i]->MHp->rng) s[i]->MHp->rng = ErgmRNGInitialize(ERGM_RNG_FAST);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if(!serial && nchains > 1) num_threads(MIN(nchains, omp_get_num_procs()))
+#endif
+  for(int i = 0; i < nchains; i++)
+    status[i] = s[i]->MHp ? WtMCMCSample(s[i], REAL(eta), samples[i], n, b, itv, nmax, v) : MCMC_MH_FAILED;
+
+  for(int i = 0; i < nchains; i++){
+    SEXP chainl = VECTOR_ELT(outl, i);
+    SET_VECTOR_ELT(chainl, 0, ScalarInteger(status[i]));
+
+    if(s[i]->mh_unsuccessful)
+      warning("MH MHProposal function failed to find a valid proposal %u time(s) in chain %d.", s[i]->mh_unsuccessful, i+1);
+
+    /* record new generated network to pass back to R */
+    if(status[i] == MCMC_OK && asInteger(maxedges) != 0){
+      s[i]->stats = samples[i] + (n-1)*s[i]->m->n_stats;
+      SET_VECTOR_ELT(chainl, 2, WtErgmStateRSave(s[i]));
+    }
+
+    WtErgmStateDestroy(s[i]);
+  }
+
+  Free(s);
+  Free(samples);
+  Free(status);
+  PutRNGstate();  /* Disable RNG before returning */
+  UNPROTECT(1);
+  return outl;
+}
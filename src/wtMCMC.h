@@ -23,6 +23,8 @@
 #define DISPATCH_MetropolisHastings WtMetropolisHastings
 #define DISPATCH_MCMCPhase12 WtMCMCPhase12
 #define DISPATCH_MCMCSamplePhase12 WtMCMCSamplePhase12
+#define DISPATCH_NetworkCompact WtNetworkCompact
+#define DISPATCH_NetworkGetEdgetreeStats WtNetworkGetEdgetreeStats
 
 #include "MCMC.h.template.do_not_include_directly.h"
 #endif
@@ -10,6 +10,7 @@
 #include "ergm_wtMHproposal.h"
 #include "ergm_wtchangestat.h"
 #include "ergm_rlebdm.h"
+#include "ergm_MHstorage.h"
 
 /*********************
  void MH_StdNormal
@@ -21,16 +22,17 @@ WtMH_P_FN(MH_StdNormal){
   
   if(MHp->ntoggles == 0) { // Initialize StdNormal 
     MHp->ntoggles=1;
+    MHp->thread_safe=TRUE;
     return;
   }
   
-  GetRandDyad(Mtail, Mhead, nwp);
+  MH_GetRandDyad(Mtail, Mhead, nwp);
   
   oldwt = GETWT(Mtail[0],Mhead[0]);
 
   const double propsd = 0.2; // This ought to be tunable.
 
-  Mweight[0] = rnorm(oldwt, propsd);    
+  Mweight[0] = MH_RNORM(oldwt, propsd);    
   
   // Symmetric proposal, but depends on the reference measure
   MHp->logratio += -(Mweight[0]*Mweight[0]-oldwt*oldwt)/2;
@@ -52,12 +54,12 @@ WtMH_P_FN(MH_Unif){
     return;
   }
   
-  GetRandDyad(Mtail, Mhead, nwp);
+  MH_GetRandDyad(Mtail, Mhead, nwp);
   
   oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
-    Mweight[0] = runif(a,b);
+    Mweight[0] = MH_RUNIF(a,b);
   }while(Mweight[0]==oldwt);
 
   MHp->logratio += 0; // h(y) is uniform and the proposal is symmetric
@@ -86,7 +88,7 @@ WtMH_P_FN(MH_UnifNonObserved){
 
   // Note that missing edgelist is indexed from 0 but the first
   // element of MHp->inputs is the number of missing edges.
-  Edge rane = 1 + unif_rand() * nmissing;
+  Edge rane = 1 + MH_UNIF_RAND() * nmissing;
 
   Mtail[0]=MHp->inputs[rane+2];
   Mhead[1]=MHp->inputs[nmissing+rane+2];
@@ -94,7 +96,7 @@ WtMH_P_FN(MH_UnifNonObserved){
   double oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
-    Mweight[0] = runif(a,b);
+    Mweight[0] = MH_RUNIF(a,b);
   }while(Mweight[0]==oldwt);
 
   MHp->logratio += 0; // h(y) is uniform and the proposal is symmetric
@@ -117,12 +119,12 @@ WtMH_P_FN(MH_DiscUnif){
     return;
   }
   
-  GetRandDyad(Mtail, Mhead, nwp);
+  MH_GetRandDyad(Mtail, Mhead, nwp);
   
   oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
-    Mweight[0] = floor(runif(a,b+1));
+    Mweight[0] = floor(MH_RUNIF(a,b+1));
   }while(Mweight[0]==oldwt);
 
   MHp->logratio += 0; // h(y) is uniform and the proposal is symmetric
@@ -150,7 +152,7 @@ WtMH_P_FN(MH_DiscUnifNonObserved){
 
   // Note that missing edgelist is indexed from 0 but the first
   // element of MHp->inputs is the number of missing edges.
-  Edge rane = 1 + unif_rand() * nmissing;
+  Edge rane = 1 + MH_UNIF_RAND() * nmissing;
 
   Mtail[0]=MHp->inputs[rane+2];
   Mhead[1]=MHp->inputs[nmissing+rane+2];
@@ -158,7 +160,7 @@ WtMH_P_FN(MH_DiscUnifNonObserved){
   double oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
-    Mweight[0] = floor(runif(a,b+1));
+    Mweight[0] = floor(MH_RUNIF(a,b+1));
   }while(Mweight[0]==oldwt);
 
   MHp->logratio += 0; // h(y) is uniform and the proposal is symmetric
@@ -180,21 +182,21 @@ void MH_DiscUnif2(WtMHProposal *MHp, WtNetwork *nwp)  {
     return;
   }
   
-  GetRandDyad(Mtail, Mhead, nwp);
+  MH_GetRandDyad(Mtail, Mhead, nwp);
   
   oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
-    Mweight[0] = floor(runif(a,b+1));
+    Mweight[0] = floor(MH_RUNIF(a,b+1));
   }while(Mweight[0]==oldwt);
 
   do{
-    GetRandDyad(Mtail+1, Mhead+1, nwp);
+    MH_GetRandDyad(Mtail+1, Mhead+1, nwp);
     
     oldwt = GETWT(Mtail[1],Mhead[1]);
     
     do{
-      Mweight[1] = floor(runif(a,b+1));
+      Mweight[1] = floor(MH_RUNIF(a,b+1));
     }while(Mweight[1]==oldwt);
   }while(Mtail[0]==Mtail[1] && Mhead[0]==Mhead[1]);
   
@@ -219,25 +221,25 @@ WtMH_P_FN(MH_DistRLE)
     return;
   }
 
-  GetRandRLEBDM1D_RS(Mtail, Mhead, &r);
+  GetRandRLEBDM1D_RS_RNG(Mtail, Mhead, &r, MHp->rng);
   double oldwt = GETWT(Mtail[0],Mhead[0]);
 
   do{
     switch((unsigned int) *inputs){
     case 0:
-      Mweight[0] = runif(inputs[1],inputs[2]);
+      Mweight[0] = MH_RUNIF(inputs[1],inputs[2]);
       break;
     case 1:
-      Mweight[0] = floor(runif(inputs[1],inputs[2]+1));
+      Mweight[0] = floor(MH_RUNIF(inputs[1],inputs[2]+1));
       break;
     case 2:
-      Mweight[0] = rnorm(inputs[1],inputs[2]);
+      Mweight[0] = MH_RNORM(inputs[1],inputs[2]);
       break;
     case 3:
-      Mweight[0] = rpois(inputs[1]);
+      Mweight[0] = MH_RPOIS(inputs[1]);
       break;
     case 4:
-      Mweight[0] = rbinom(inputs[1],inputs[2]);
+      Mweight[0] = MH_RBINOM(inputs[1],inputs[2]);
       break;
     }
   }while(Mweight[0]==oldwt);
@@ -245,3 +247,170 @@ WtMH_P_FN(MH_DistRLE)
   // MHp->logratio += 0; // h(y) is uniform and the proposal is symmetric
 }
 
+
+/* Draw a value from the reference distribution encoded in inputs as
+   for MH_DistRLE, using the proposal's generator. */
+static inline double DistDraw(WtMHProposal *MHp, double *inputs){
+  switch((unsigned int) inputs[0]){
+  case 0: return MH_RUNIF(inputs[1],inputs[2]);
+  case 1: return floor(MH_RUNIF(inputs[1],inputs[2]+1));
+  case 2: return MH_RNORM(inputs[1],inputs[2]);
+  case 3: return MH_RPOIS(inputs[1]);
+  default: return MH_RBINOM(inputs[1],inputs[2]);
+  }
+}
+
+/********************
+   void MH_DistBlock
+
+   Selects a random node and a block of up to MH_IINPUTS[0] distinct
+   dyads in its row (i.e., with it as the tail, or incident on it if
+   the network is undirected or it is in the second mode),
+   independently of the network, and proposes new values for all of
+   them at once, each drawn from the reference distribution encoded in
+   MH_INPUTS as for MH_DistRLE, so that the proposal is its own
+   reference-measure correction. Dyads whose value would not change
+   are dropped from the proposal.
+
+   If MH_IINPUTS[1] is nonzero, the reference distribution must be
+   discrete with finite support, and the proposal sets MHp->gibbs so
+   that the MCMC sampler can draw each value in the block from its
+   full conditional distribution instead (other samplers will propose
+   the independent draws).
+***********************/
+WtMH_I_FN(Mi_DistBlock){
+  Vertex nalters = BIPARTITE ? MAX(BIPARTITE, N_NODES - BIPARTITE) : N_NODES - 1;
+  MHp->ntoggles = MIN((Vertex) MH_IINPUTS[0], nalters);
+  if(MHp->ntoggles == 0){
+    MHp->ntoggles = MH_FAILED;
+    return;
+  }
+  MHp->thread_safe = TRUE;
+
+  if(MH_IINPUTS[1]){
+    // The support and the log-reference-measure of each value in it.
+    double lo = MH_INPUTS[0] == 1 ? MH_INPUTS[1] : 0,
+      hi = MH_INPUTS[0] == 1 ? MH_INPUTS[2] : MH_INPUTS[1];
+    MHp->gibbs = hi - lo + 1;
+    MH_ALLOC_STORAGE(2*MHp->gibbs, double, vals);
+    MHp->gibbs_values = vals;
+    MHp->gibbs_logh = vals + MHp->gibbs;
+    for(unsigned int v = 0; v < MHp->gibbs; v++){
+      MHp->gibbs_values[v] = lo + v;
+      MHp->gibbs_logh[v] = MH_INPUTS[0] == 1 ? 0 : dbinom(lo + v, MH_INPUTS[1], MH_INPUTS[2], TRUE);
+    }
+  }
+}
+
+WtMH_P_FN(Mp_DistBlock){
+  Vertex root = 1 + MH_UNIF_RAND() * N_NODES;
+  Vertex first = 1, nchoices = N_NODES, nalters = N_NODES - 1;
+  if(BIPARTITE){
+    if(root <= BIPARTITE){ first = BIPARTITE + 1; nchoices = nalters = N_NODES - BIPARTITE; }
+    else nchoices = nalters = BIPARTITE;
+  }
+  unsigned int k = MIN((Vertex) MH_IINPUTS[0], nalters);
+
+  unsigned int j = 0;
+  if(k == nalters){ // The whole row.
+    for(Vertex alter = first; alter < first + nchoices; alter++){
+      if(alter == root) continue;
+      Mtail[j] = root;
+      Mhead[j] = alter;
+      j++;
+    }
+  }else{
+    while(j < k){
+      Vertex alter = first + MH_UNIF_RAND() * nchoices;
+      if(alter == root) continue;
+
+      unsigned int i;
+      for(i = 0; i < j; i++)
+        if(Mhead[i] == alter) break;
+      if(i < j) continue;
+
+      Mtail[j] = root;
+      Mhead[j] = alter;
+      j++;
+    }
+  }
+
+  MHp->ntoggles = 0;
+  for(unsigned int i = 0; i < k; i++){
+    Vertex tail = Mtail[i], head = Mhead[i];
+    if(BIPARTITE ? root > BIPARTITE : !DIRECTED && root > head){
+      tail = head;
+      head = root;
+    }
+
+    double newwt = DistDraw(MHp, MH_INPUTS);
+    if(!MHp->gibbs && newwt == GETWT(tail, head)) continue;
+
+    Mtail[MHp->ntoggles] = tail;
+    Mhead[MHp->ntoggles] = head;
+    Mweight[MHp->ntoggles] = newwt;
+    MHp->ntoggles++;
+  }
+
+  if(MHp->ntoggles == 0){ // Nothing would change.
+    Mtail[0] = MH_FAILED;
+    Mhead[0] = MH_CONSTRAINT;
+  }
+}
+
+/********************
+   void MH_DistTNT
+
+   Tie/no tie for count-valued networks: with probability 1/2 (if
+   there are any), selects a dyad with a nonzero value uniformly at
+   random from the edge trees, and otherwise selects a dyad uniformly
+   at random, so that sparse networks do not spend most proposals on
+   zeroes. The new value is drawn from a Poisson distribution with
+   mean one half more than the current value, conditional on it being
+   different.
+
+   MH_IINPUTS[0] gives the reference measure: 0 for Poisson
+   (h(y)=1/y!) and 1 for geometric (h(y)=1).
+***********************/
+
+/* The probability of selecting a dyad whose value is nonzero or not,
+   with nedges nonzero dyads in the network. */
+static inline double DistTNTSelect(Rboolean nonzero, Edge nedges, Dyad ndyads){
+  const double P = 0.5;
+  return nedges ? (nonzero ? P/nedges : 0) + (1-P)/ndyads : 1.0/ndyads;
+}
+
+/* Log-probability of proposing y1 from y0. */
+static inline double DistTNTLogQ(double y1, double y0){
+  return dpois(y1, y0+0.5, TRUE) - log1p(-dpois(y0, y0+0.5, FALSE));
+}
+
+WtMH_I_FN(Mi_DistTNT){
+  MHp->ntoggles = DYADCOUNT(nwp) ? 1 : MH_FAILED;
+  MHp->thread_safe = TRUE;
+}
+
+WtMH_P_FN(Mp_DistTNT){
+  const double P = 0.5;
+  Edge nedges = EDGECOUNT(nwp);
+  Dyad ndyads = DYADCOUNT(nwp);
+  double oldwt;
+
+  if(nedges > 0 && MH_UNIF_RAND() < P) MH_WtGetRandEdge(Mtail, Mhead, &oldwt, nwp);
+  else{
+    MH_GetRandDyad(Mtail, Mhead, nwp);
+    oldwt = GETWT(Mtail[0], Mhead[0]);
+  }
+
+  do{
+    Mweight[0] = MH_RPOIS(oldwt + 0.5);
+  }while(Mweight[0] == oldwt);
+
+  Edge newnedges = nedges + (oldwt == 0) - (Mweight[0] == 0);
+
+  MHp->logratio += log(DistTNTSelect(Mweight[0] != 0, newnedges, ndyads)) - log(DistTNTSelect(oldwt != 0, nedges, ndyads))
+    + DistTNTLogQ(oldwt, Mweight[0]) - DistTNTLogQ(Mweight[0], oldwt);
+
+  if(MH_IINPUTS[0] == 0) // Poisson reference
+    MHp->logratio += lgammafn(oldwt+1) - lgammafn(Mweight[0]+1);
+}
@@ -8,6 +8,7 @@
  *  Copyright 2003-2022 Statnet Commons
  */
 #include "wtchangestats.h"
+#include "wtchangestats_twopath.h"
 
 /********************  changestats:   A    ***********/
 
@@ -74,22 +75,6 @@ WtC_CHANGESTAT_FN(c_absdiffcat_sum){
 }
 
 
-/*****************
- stat: atleast
-*****************/
-WtC_CHANGESTAT_FN(c_atleast){
-  for(unsigned int i=0; i<N_CHANGE_STATS; i++)
-    CHANGE_STAT[i] += (weight>=INPUT_ATTRIB[i]) - (edgestate>=INPUT_ATTRIB[i]);
-}
-
-/*****************
- stat: atmost
-*****************/
-WtC_CHANGESTAT_FN(c_atmost){
-  for(unsigned int i=0; i<N_CHANGE_STATS; i++)
-    CHANGE_STAT[i] += (weight<=INPUT_ATTRIB[i]) - (edgestate<=INPUT_ATTRIB[i]);
-}
-
 /********************  changestats:   B    ***********/
 
 /*****************
@@ -138,6 +123,38 @@ WtC_CHANGESTAT_FN(c_cyclicalweights){
   unsigned int path = INPUT_ATTRIB[0], combine = INPUT_ATTRIB[1], compare =  INPUT_ATTRIB[2];
   CHANGE_STAT[0]=0;
 
+  StoreTwoPathWt *tp = N_AUX ? AUX_STORAGE : NULL;
+  if(tp){
+    // (tail,head) as the focus dyad, closing the 2-paths from head to tail
+    double two_paths = TwoPathWtGet(tp, head, tail);
+    CHANGE_STAT[0] += TWOPATH_AFFECT(compare, two_paths, weight) - TWOPATH_AFFECT(compare, two_paths, edgestate);
+
+    // (tail,head) as the first link of a 2-path from tail to j, closed by (j,tail)
+    EXEC_THROUGH_INEDGES(tail, e, j, yjt, {
+        if(j==head) continue;
+        double yhj = GETWT(head, j);
+        if(yhj==0) continue;
+        double old_two_paths = TwoPathWtGet(tp, tail, j);
+        double new_two_paths = TwoPathWtReplaced(tp, tail, j,
+                                                 edgestate!=0 ? TWOPATH_VALUE(path, edgestate, yhj) : 0,
+                                                 weight!=0 ? TWOPATH_VALUE(path, weight, yhj) : 0);
+        CHANGE_STAT[0] += TWOPATH_AFFECT(compare, new_two_paths, yjt) - TWOPATH_AFFECT(compare, old_two_paths, yjt);
+      });
+
+    // (tail,head) as the second link of a 2-path from i to head, closed by (head,i)
+    EXEC_THROUGH_OUTEDGES(head, e, i, yhi, {
+        if(i==tail) continue;
+        double yit = GETWT(i, tail);
+        if(yit==0) continue;
+        double old_two_paths = TwoPathWtGet(tp, i, head);
+        double new_two_paths = TwoPathWtReplaced(tp, i, head,
+                                                 edgestate!=0 ? TWOPATH_VALUE(path, yit, edgestate) : 0,
+                                                 weight!=0 ? TWOPATH_VALUE(path, yit, weight) : 0);
+        CHANGE_STAT[0] += TWOPATH_AFFECT(compare, new_two_paths, yhi) - TWOPATH_AFFECT(compare, old_two_paths, yhi);
+      });
+    return;
+  }
+
       // (tail,head) as the focus dyad
       // This means that the strongest 2-path doesn't change.
       double two_paths = 0;
@@ -419,22 +436,8 @@ WtC_CHANGESTAT_FN(c_diff_sum) {
     
 /********************  changestats:   G    ***********/
 
-/*****************
- stat: greaterthan
-*****************/
-WtC_CHANGESTAT_FN(c_greaterthan){
-  for(unsigned int i=0; i<N_CHANGE_STATS; i++)
-    CHANGE_STAT[i] += (weight>INPUT_ATTRIB[i]) - (edgestate>INPUT_ATTRIB[i]);
-}
-
 /********************  changestats:   I    ***********/
 
-/*****************
- stat: ininterval
-*****************/
-WtC_CHANGESTAT_FN(c_ininterval){
-      CHANGE_STAT[0] += ((INPUT_ATTRIB[2] ? weight>INPUT_ATTRIB[0] : weight>=INPUT_ATTRIB[0]) && (INPUT_ATTRIB[3] ? weight<INPUT_ATTRIB[1] : weight<=INPUT_ATTRIB[1])) - ((INPUT_ATTRIB[2] ? edgestate>INPUT_ATTRIB[0] : edgestate>=INPUT_ATTRIB[0]) && (INPUT_ATTRIB[3] ? edgestate<INPUT_ATTRIB[1] : edgestate<=INPUT_ATTRIB[1]));
-}
 /********************  changestats:   L    ***********/
 
 /********************  changestats:   M    ***********/
@@ -1050,14 +1053,6 @@ WtC_CHANGESTAT_FN(c_nonzero){
 
 /********************  changestats:   S    ***********/
 
-/*****************
- stat: smallerthan
-*****************/
-WtC_CHANGESTAT_FN(c_smallerthan){
-  for(unsigned int i=0; i<N_CHANGE_STATS; i++)
-    CHANGE_STAT[i] += (weight<INPUT_ATTRIB[i]) - (edgestate<INPUT_ATTRIB[i]);
-}
-
 /*****************
  stat: sum
 *****************/
@@ -1075,6 +1070,43 @@ WtC_CHANGESTAT_FN(c_sum_pow){
 }
 /********************  changestats:   T    ***********/
 
+/* The cell of the real line containing x, where the m increasing
+   breakpoints in b divide it into 2m+1 cells: cell 2k is the open
+   interval between the kth and the (k+1)th breakpoint, and cell 2k+1
+   is the (k+1)th breakpoint itself. */
+static inline unsigned int threshold_cell(double x, const double *b, unsigned int m){
+  unsigned int lo = 0, hi = m;
+  while(lo < hi){
+    unsigned int mid = (lo + hi) / 2;
+    if(b[mid] < x) lo = mid + 1; else hi = mid;
+  }
+  return 2*lo + (lo < m && b[lo] == x);
+}
+
+/*****************
+ stat: thresholds
+
+ A bank of statistics counting the dyads whose values fall into
+ intervals (or their complements), used by atleast, atmost,
+ greaterthan, smallerthan, ininterval, and equalto, and by adjacent
+ such terms fused into one. INPUT_PARAM holds the number m of distinct
+ finite interval endpoints, the endpoints in increasing order, and a
+ table giving, for each of the 2m+1 cells of the real line that they
+ define, the contribution of a dyad whose value is in that cell to
+ each of the statistics. A change thus needs one binary search for
+ each of the two values, however many thresholds there are.
+*****************/
+WtC_CHANGESTAT_FN(c_thresholds){
+  unsigned int m = INPUT_PARAM[0];
+  const double *b = INPUT_PARAM + 1, *table = b + m;
+  unsigned int cw = threshold_cell(weight, b, m), ce = threshold_cell(edgestate, b, m);
+  if(cw == ce) return;
+
+  const double *tw = table + cw*N_CHANGE_STATS, *te = table + ce*N_CHANGE_STATS;
+  for(unsigned int i=0; i<N_CHANGE_STATS; i++)
+    CHANGE_STAT[i] += tw[i] - te[i];
+}
+
 /*****************
  stat: transitiveweights
 *****************/
@@ -1082,6 +1114,38 @@ WtC_CHANGESTAT_FN(c_sum_pow){
 WtC_CHANGESTAT_FN(c_transitiveweights){ 
   CHANGE_STAT[0]=0;
   unsigned int path = INPUT_ATTRIB[0], combine = INPUT_ATTRIB[1], compare =  INPUT_ATTRIB[2];
+
+  StoreTwoPathWt *tp = N_AUX ? AUX_STORAGE : NULL;
+  if(tp){
+    // (tail,head) as the focus dyad, spanning the 2-paths from tail to head
+    double two_paths = TwoPathWtGet(tp, tail, head);
+    CHANGE_STAT[0] += TWOPATH_AFFECT(compare, two_paths, weight) - TWOPATH_AFFECT(compare, two_paths, edgestate);
+
+    // (tail,head) as the first link of a 2-path from tail to j, spanned by (tail,j)
+    EXEC_THROUGH_OUTEDGES(tail, e, j, ytj, {
+        if(j==head) continue;
+        double yhj = GETWT(head, j);
+        if(yhj==0) continue;
+        double old_two_paths = TwoPathWtGet(tp, tail, j);
+        double new_two_paths = TwoPathWtReplaced(tp, tail, j,
+                                                 edgestate!=0 ? TWOPATH_VALUE(path, edgestate, yhj) : 0,
+                                                 weight!=0 ? TWOPATH_VALUE(path, weight, yhj) : 0);
+        CHANGE_STAT[0] += TWOPATH_AFFECT(compare, new_two_paths, ytj) - TWOPATH_AFFECT(compare, old_two_paths, ytj);
+      });
+
+    // (tail,head) as the second link of a 2-path from i to head, spanned by (i,head)
+    EXEC_THROUGH_INEDGES(head, e, i, yih, {
+        if(i==tail) continue;
+        double yit = GETWT(i, tail);
+        if(yit==0) continue;
+        double old_two_paths = TwoPathWtGet(tp, i, head);
+        double new_two_paths = TwoPathWtReplaced(tp, i, head,
+                                                 edgestate!=0 ? TWOPATH_VALUE(path, yit, edgestate) : 0,
+                                                 weight!=0 ? TWOPATH_VALUE(path, yit, weight) : 0);
+        CHANGE_STAT[0] += TWOPATH_AFFECT(compare, new_two_paths, yih) - TWOPATH_AFFECT(compare, old_two_paths, yih);
+      });
+    return;
+  }
   
       // (tail,head) as the focus dyad
       // This means that the combined 2-path value doesn't change.
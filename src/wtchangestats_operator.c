@@ -10,6 +10,7 @@
 #include "wtchangestats_operator.h"
 #include "ergm_wtchangestats_operator.h"
 #include "ergm_util.h"
+#include "changestats_sum.h"
 
 /* passthrough(formula) */
 
@@ -307,6 +308,12 @@ WtF_CHANGESTAT_FN(f__wtsubmodel_and_summary_term){
 
 // wtSum: Take a weighted sum of the models' statistics.
 
+typedef struct {
+  unsigned int nms;
+  WtModel **ms;
+  SumMap *maps;
+} StoreSumWtModel;
+
 WtI_CHANGESTAT_FN(i_wtSum){
   /*
     inputs expected:
@@ -315,78 +322,66 @@ WtI_CHANGESTAT_FN(i_wtSum){
     tml: a list of mapping matrices in row-major order
     nms*?: submodel specifications for nms submodels
   */
-  
+
   double *inputs = INPUT_PARAM; 
   unsigned int nms = *(inputs++);
-  unsigned int tml = *(inputs++);
-  inputs+=tml; // Jump to start of model specifications.
-  
-  ALLOC_STORAGE(nms, WtModel*, ms);
+  inputs++; //  Skip total length of weight matrices.
+  double *wts = inputs;
+
+  ALLOC_STORAGE(1, StoreSumWtModel, sto);
+  sto->nms = nms;
+  sto->ms = Calloc(nms, WtModel*);
+  sto->maps = Calloc(nms, SumMap);
 
   SEXP submodels = getListElement(mtp->R, "submodels");
   for(unsigned int i=0; i<nms; i++){
-    ms[i] = WtModelInitialize(VECTOR_ELT(submodels,i), isNULL(mtp->ext_state) ? NULL : VECTOR_ELT(mtp->ext_state,i), nwp, FALSE);
+    WtModel *m = sto->ms[i] = WtModelInitialize(VECTOR_ELT(submodels,i), isNULL(mtp->ext_state) ? NULL : VECTOR_ELT(mtp->ext_state,i), nwp, FALSE);
+    SumMapInitialize(sto->maps + i, wts, N_CHANGE_STATS, m->n_stats);
+    wts += N_CHANGE_STATS*m->n_stats;
   }
-  WtDELETE_IF_UNUSED_IN_SUBMODELS(x_func, ms, nms);
-  WtDELETE_IF_UNUSED_IN_SUBMODELS(z_func, ms, nms);
+  WtDELETE_IF_UNUSED_IN_SUBMODELS(x_func, sto->ms, nms);
+  WtDELETE_IF_UNUSED_IN_SUBMODELS(z_func, sto->ms, nms);
 }
 
 WtC_CHANGESTAT_FN(c_wtSum){
-  double *inputs = INPUT_PARAM; 
-  GET_STORAGE(WtModel*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSumWtModel, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    WtModel *m = ms[i];
+  for(unsigned int i=0; i<sto->nms; i++){
+    WtModel *m = sto->ms[i];
     WtChangeStats1(tail, head, weight, nwp, m, edgestate);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 WtZ_CHANGESTAT_FN(z_wtSum){
-  double *inputs = INPUT_PARAM;
-  GET_STORAGE(WtModel*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSumWtModel, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    WtModel *m = ms[i];
+  for(unsigned int i=0; i<sto->nms; i++){
+    WtModel *m = sto->ms[i];
     WtZStats(nwp, m, FALSE);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 WtX_CHANGESTAT_FN(x_wtSum){
-  double *inputs = INPUT_PARAM;
-  GET_STORAGE(WtModel*, ms);
-  unsigned int nms = *(inputs++);
-  inputs++; //  Skip total length of weight matrices.
-  double *wts = inputs;
+  GET_STORAGE(StoreSumWtModel, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    WtModel *m = ms[i];
+  for(unsigned int i=0; i<sto->nms; i++){
+    WtModel *m = sto->ms[i];
     WtPROPAGATE_X_SIGNAL_INTO(nwp, m, m->workspace);
-    for(unsigned int j=0; j<m->n_stats; j++)
-      for(unsigned int k=0; k<N_CHANGE_STATS; k++)
-	CHANGE_STAT[k] += m->workspace[j]* *(wts++);
+    SumMapAddOnto(CHANGE_STAT, m->workspace, sto->maps + i);
   }
 }
 
 WtF_CHANGESTAT_FN(f_wtSum){
-  double *inputs = INPUT_PARAM; 
-  GET_STORAGE(WtModel*, ms);
-  unsigned int nms = *(inputs++);
+  GET_STORAGE(StoreSumWtModel, sto);
 
-  for(unsigned int i=0; i<nms; i++){
-    WtModelDestroy(nwp, ms[i]);
+  for(unsigned int i=0; i<sto->nms; i++){
+    WtModelDestroy(nwp, sto->ms[i]);
+    SumMapDestroy(sto->maps + i);
   }
+  Free(sto->ms);
+  Free(sto->maps);
 }
 
 
@@ -0,0 +1,121 @@
+/*  File src/wtchangestats_twopath.c in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#include "wtchangestats_twopath.h"
+
+/* Add a 2-path of strength v > 0 from i to j. */
+static inline void TwoPathWtAdd(StoreTwoPathWt *sto, Vertex i, Vertex j, double v){
+  int ret;
+  khint_t pos = kh_put(DyadMapTwoPath, sto->tp, TH(i, j), &ret);
+  TwoPathSet *s = &kh_value(sto->tp, pos);
+  if(ret) memset(s, 0, sizeof(TwoPathSet));
+
+  if(sto->combine == TWOPATH_COMBINE_SUM){
+    s->sum += v;
+  }else{
+    if(s->n == s->cap){
+      s->cap = s->cap ? s->cap*2 : 4;
+      s->vals = Realloc(s->vals, s->cap, double);
+    }
+    // Insert, keeping the values in decreasing order.
+    unsigned int k = s->n;
+    while(k > 0 && s->vals[k-1] < v){
+      s->vals[k] = s->vals[k-1];
+      k--;
+    }
+    s->vals[k] = v;
+  }
+  s->n++;
+}
+
+/* Remove a 2-path of strength v > 0 from i to j. */
+static inline void TwoPathWtDel(StoreTwoPathWt *sto, Vertex i, Vertex j, double v){
+  khint_t pos = kh_get(DyadMapTwoPath, sto->tp, TH(i, j));
+  TwoPathSet *s = &kh_value(sto->tp, pos);
+
+  if(--s->n == 0){
+    // Drop the entry, which also avoids accumulating rounding error in the sum.
+    Free(s->vals);
+    kh_del(DyadMapTwoPath, sto->tp, pos);
+    return;
+  }
+
+  if(sto->combine == TWOPATH_COMBINE_SUM){
+    s->sum -= v;
+  }else{
+    // The values are recomputed from the same weights, so they match exactly.
+    unsigned int k = 0;
+    while(s->vals[k] != v) k++;
+    memmove(s->vals + k, s->vals + k + 1, (s->n - k)*sizeof(double));
+  }
+}
+
+/* Change the strength of a 2-path from i to j from oldv to newv,
+   where 0 means that the 2-path does not exist. */
+static inline void TwoPathWtReplace(StoreTwoPathWt *sto, Vertex i, Vertex j, double oldv, double newv){
+  if(oldv == newv) return;
+  if(oldv != 0) TwoPathWtDel(sto, i, j, oldv);
+  if(newv != 0) TwoPathWtAdd(sto, i, j, newv);
+}
+
+/*****************
+ Auxiliary: _wttwopath_net
+
+ Maintains a StoreTwoPathWt: the strengths of the 2-paths between
+ every pair of vertices, for INPUT_PARAM[0] giving their strength
+ (TWOPATH_MIN or TWOPATH_GEOMEAN) and INPUT_PARAM[1] giving how they
+ are combined (TWOPATH_COMBINE_MAX or TWOPATH_COMBINE_SUM).
+*****************/
+
+WtI_CHANGESTAT_FN(i__wttwopath_net){
+  ALLOC_AUX_STORAGE(1, StoreTwoPathWt, sto);
+  sto->path = INPUT_PARAM[0];
+  sto->combine = INPUT_PARAM[1];
+  sto->tp = kh_init(DyadMapTwoPath);
+  sto->tp->directed = DIRECTED;
+
+  for(Vertex k = 1; k <= N_NODES; k++){
+    EXEC_THROUGH_INEDGES(k, e1, i, yik, {
+        EXEC_THROUGH_OUTEDGES(k, e2, j, ykj, {
+            // If undirected, visit each 2-path only once.
+            if(DIRECTED ? i != j : i < j) TwoPathWtAdd(sto, i, j, TWOPATH_VALUE(sto->path, yik, ykj));
+          });
+      });
+  }
+}
+
+WtU_CHANGESTAT_FN(u__wttwopath_net){
+  GET_AUX_STORAGE(StoreTwoPathWt, sto);
+
+  // (tail,head) as the first link of a 2-path from tail
+  EXEC_THROUGH_OUTEDGES(head, e, j, yhj, {
+      if(j == tail) continue;
+      TwoPathWtReplace(sto, tail, j,
+                       edgestate != 0 ? TWOPATH_VALUE(sto->path, edgestate, yhj) : 0,
+                       weight != 0 ? TWOPATH_VALUE(sto->path, weight, yhj) : 0);
+    });
+
+  // (tail,head) as the second link of a 2-path to head
+  EXEC_THROUGH_INEDGES(tail, e, i, yit, {
+      if(i == head) continue;
+      TwoPathWtReplace(sto, i, head,
+                       edgestate != 0 ? TWOPATH_VALUE(sto->path, yit, edgestate) : 0,
+                       weight != 0 ? TWOPATH_VALUE(sto->path, yit, weight) : 0);
+    });
+}
+
+WtF_CHANGESTAT_FN(f__wttwopath_net){
+  GET_AUX_STORAGE(StoreTwoPathWt, sto);
+  if(sto->combine != TWOPATH_COMBINE_SUM){
+    TwoPathSet s;
+    kh_foreach_value(sto->tp, s, Free(s.vals));
+  }
+  kh_destroy(DyadMapTwoPath, sto->tp);
+  // sto itself is freed by the framework.
+}
@@ -0,0 +1,79 @@
+/*  File src/wtchangestats_twopath.h in package ergm, part of the
+ *  Statnet suite of packages for network analysis, https://statnet.org .
+ *
+ *  This software is distributed under the GPL-3 license.  It is free,
+ *  open source, and has the attribution requirements (GPL Section 7) at
+ *  https://statnet.org/attribution .
+ *
+ *  Copyright 2003-2022 Statnet Commons
+ */
+#ifndef _WTCHANGESTATS_TWOPATH_H_
+#define _WTCHANGESTATS_TWOPATH_H_
+
+#include "ergm_wtedgetree.h"
+#include "ergm_wtchangestat.h"
+#include "ergm_storage.h"
+#include "ergm_dyad_hashmap.h"
+
+/* Codes for the strength of a 2-path and for how the strengths of
+   the 2-paths between a pair of vertices are combined, as used by
+   the transitiveweights and cyclicalweights terms. */
+#define TWOPATH_MIN 1
+#define TWOPATH_GEOMEAN 2
+#define TWOPATH_COMBINE_MAX 1
+#define TWOPATH_COMBINE_SUM 2
+
+#define TWOPATH_VALUE(path, y1, y2) ((path) == TWOPATH_MIN ? fmin((y1), (y2)) : sqrt((y1) * (y2)))
+
+/* How the combined strength of the 2-paths affects the statistic for
+   a dyad with value y: through their minimum (1) or geometric mean (2). */
+#define TWOPATH_AFFECT(compare, two_paths, y) ((compare) == 1 ? fmin((two_paths), (y)) : sqrt((two_paths) * (y)))
+
+/* The strengths of the n 2-paths from one vertex to another. For
+   combine="sum", only their sum is kept; for combine="max", vals holds
+   them in decreasing order. Since weights are nonnegative and only
+   nonzero weights are stored, a 2-path exists iff its strength is
+   positive. */
+typedef struct TwoPathSetstruct {
+  unsigned int n, cap;
+  double sum;
+  double *vals;
+} TwoPathSet;
+
+KHASH_INIT(DyadMapTwoPath, TailHead, TwoPathSet, TRUE, kh_vertexvertex_hash_func, kh_vertexvertex_hash_equal, Rboolean directed;)
+
+/* Storage for the 2-path weight auxiliary. tp maps each ordered pair
+   (unordered, if undirected) of vertices connected by at least one
+   2-path onto its TwoPathSet. */
+typedef struct StoreTwoPathWtstruct {
+  unsigned int path, combine;
+  khash_t(DyadMapTwoPath) *tp;
+} StoreTwoPathWt;
+
+/* The combined strength of the 2-paths from i to j. */
+static inline double TwoPathWtGet(StoreTwoPathWt *sto, Vertex i, Vertex j){
+  khint_t pos = kh_get(DyadMapTwoPath, sto->tp, TH(i, j));
+  if(pos == kh_none) return 0;
+  TwoPathSet *s = &kh_value(sto->tp, pos);
+  return sto->combine == TWOPATH_COMBINE_SUM ? s->sum : s->vals[0];
+}
+
+/* The combined strength of the 2-paths from i to j if the one with
+   strength oldv were to have strength newv instead, where 0 means
+   that there is no such 2-path. */
+static inline double TwoPathWtReplaced(StoreTwoPathWt *sto, Vertex i, Vertex j, double oldv, double newv){
+  khint_t pos = kh_get(DyadMapTwoPath, sto->tp, TH(i, j));
+  if(pos == kh_none) return newv;
+  TwoPathSet *s = &kh_value(sto->tp, pos);
+
+  if(sto->combine == TWOPATH_COMBINE_SUM)
+    return s->n - (oldv != 0) + (newv != 0) ? s->sum - oldv + newv : 0;
+
+  double cur = s->vals[0];
+  if(newv >= cur) return newv;
+  if(oldv != cur) return cur;
+  // The strongest 2-path is getting weaker; fall back to the next one.
+  return fmax(s->n > 1 ? s->vals[1] : 0, newv);
+}
+
+#endif // _WTCHANGESTATS_TWOPATH_H_
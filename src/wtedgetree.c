@@ -43,6 +43,9 @@ WtNetwork *WtNetworkInitialize(Vertex *tails, Vertex *heads, double *weights,
   nwp->maxedges = MAX(nedges,1)+nnodes+2; /* Maybe larger than needed? */
   nwp->inedges = (WtTreeNode *) Calloc(nwp->maxedges, WtTreeNode);
   nwp->outedges = (WtTreeNode *) Calloc(nwp->maxedges, WtTreeNode);
+  nwp->wttype = WT_DOUBLE;
+  nwp->inweights = Calloc(nwp->maxedges, double);
+  nwp->outweights = Calloc(nwp->maxedges, double);
 
   if(lasttoggle_flag) error("The lasttoggle API has been removed from ergm.");
 
@@ -108,6 +111,8 @@ void WtNetworkDestroy(WtNetwork *nwp) {
   Free(nwp->outdegree);
   Free(nwp->inedges);
   Free(nwp->outedges);
+  Free(nwp->inweights);
+  Free(nwp->outweights);
   Free(nwp);
 }
 
@@ -133,20 +138,126 @@ WtNetwork *WtNetworkCopy(WtNetwork *src){
   dest->outedges = (WtTreeNode *) Calloc(maxedges, WtTreeNode);
   memcpy(dest->outedges, src->outedges, maxedges*sizeof(WtTreeNode));
 
+  dest->wttype = src->wttype;
+  size_t wtsize = WtWeightSize(src->wttype);
+  dest->inweights = Calloc(maxedges*wtsize, char);
+  memcpy(dest->inweights, src->inweights, maxedges*wtsize);
+  dest->outweights = Calloc(maxedges*wtsize, char);
+  memcpy(dest->outweights, src->outweights, maxedges*wtsize);
+
   dest->directed_flag = src->directed_flag;
   dest->bipartite = src->bipartite;
+  dest->eattrname = src->eattrname;
 
   EDGECOUNT(dest) = EDGECOUNT(src);
 
   return dest;
 }
 
+/*****************
+ Rboolean WtNetworkSetWeightType
+
+ Convert the weights of the network to be stored as wttype. If some
+ weight cannot be stored as wttype, leave the network unchanged and
+ return FALSE; otherwise, return TRUE.
+*****************/
+static void *WtWeightsConvert(void *weights, WtWeightType from, WtWeightType to, Edge maxedges){
+  void *newweights = Calloc(maxedges*WtWeightSize(to), char);
+  for(Edge e = 0; e < maxedges; e++)
+    WtWeightPut(newweights, to, e, WtWeightGet(weights, from, e));
+  Free(weights);
+  return newweights;
+}
+
+Rboolean WtNetworkSetWeightType(WtNetwork *nwp, WtWeightType wttype){
+  if(wttype == nwp->wttype) return TRUE;
+
+  // Every edge appears once among the out-edges.
+  for(Edge e = 1; e <= nwp->last_outedge; e++)
+    if(nwp->outedges[e].value != 0 && !WtWeightFits(wttype, WtWeightGet(nwp->outweights, nwp->wttype, e)))
+      return FALSE;
+
+  nwp->inweights = WtWeightsConvert(nwp->inweights, nwp->wttype, wttype, nwp->maxedges);
+  nwp->outweights = WtWeightsConvert(nwp->outweights, nwp->wttype, wttype, nwp->maxedges);
+  nwp->wttype = wttype;
+  return TRUE;
+}
+
 /* *** don't forget, edges are now given by tails -> heads, and as
        such, the function definitions now require tails to be passed
        in before heads */
 
 
 
+/*****************
+ void WtNetworkCompact
+
+ As NetworkCompact(), for a WtNetwork.
+*****************/
+
+/* Place vals[lo..hi] (with weights wts[lo..hi]) as a balanced subtree
+   rooted at edges[slot], taking the WtTreeNodes for its descendants
+   from *next onwards. */
+static Edge WtEdgetreePlaceBalanced(WtTreeNode *edges, void *weights, WtWeightType wttype,
+                                    Vertex *vals, double *wts,
+                                    Edge lo, Edge hi, Edge slot, Edge parent, Edge *next){
+  Edge mid = lo + (hi-lo)/2;
+  WtTreeNode *ptr = edges+slot;
+  ptr->value = vals[mid];
+  WtWeightPut(weights, wttype, slot, wts[mid]);
+  ptr->parent = parent;
+  ptr->left = mid > lo ? WtEdgetreePlaceBalanced(edges, weights, wttype, vals, wts, lo, mid-1, (*next)++, slot, next) : 0;
+  ptr->right = mid < hi ? WtEdgetreePlaceBalanced(edges, weights, wttype, vals, wts, mid+1, hi, (*next)++, slot, next) : 0;
+  return slot;
+}
+
+static WtTreeNode *WtEdgetreeCompact(WtTreeNode *edges, void **weights, WtWeightType wttype,
+                                     Vertex nnodes, Vertex *degree,
+                                     Edge newmax, Edge *last_edge){
+  WtTreeNode *newedges = Calloc(newmax, WtTreeNode);
+  void *newweights = Calloc(newmax*WtWeightSize(wttype), char);
+  Vertex maxdeg = 0;
+  for(Vertex a = 1; a <= nnodes; a++) maxdeg = MAX(maxdeg, degree[a]);
+  Vertex *vals = Calloc(maxdeg, Vertex);
+  double *wts = Calloc(maxdeg, double);
+
+  Edge next = nnodes + 1;
+  for(Vertex a = 1; a <= nnodes; a++){
+    if(degree[a] == 0) continue;
+    Edge k = 0;
+    for(Edge e = WtEdgetreeMinimum(edges, a); e != 0; e = WtEdgetreeSuccessor(edges, e)){
+      vals[k] = edges[e].value;
+      wts[k] = WtWeightGet(*weights, wttype, e);
+      k++;
+    }
+    WtEdgetreePlaceBalanced(newedges, newweights, wttype, vals, wts, 0, k-1, a, 0, &next);
+  }
+  *last_edge = next - 1;
+
+  Free(vals);
+  Free(wts);
+  Free(edges);
+  Free(*weights);
+  *weights = newweights;
+  return newedges;
+}
+
+void WtNetworkCompact(WtNetwork *nwp){
+  Vertex nnodes = nwp->nnodes;
+  // Keep some room to grow, but not more than was there already.
+  Edge newmax = MIN(nwp->maxedges, nnodes + 2 + 2*MAX(EDGECOUNT(nwp), 1));
+
+  nwp->outedges = WtEdgetreeCompact(nwp->outedges, &nwp->outweights, nwp->wttype, nnodes, nwp->outdegree, newmax, &nwp->last_outedge);
+  nwp->inedges = WtEdgetreeCompact(nwp->inedges, &nwp->inweights, nwp->wttype, nnodes, nwp->indegree, newmax, &nwp->last_inedge);
+  nwp->maxedges = newmax;
+}
+
+/* As NetworkGetEdgetreeStats(), for a WtNetwork. */
+#define DISPATCH_Network WtNetwork
+#define DISPATCH_TreeNode WtTreeNode
+#define DISPATCH_NetworkGetEdgetreeStats WtNetworkGetEdgetreeStats
+#include "edgetree.c.template.do_not_include_directly.h"
+
 /*****************
  int WtToggleEdge
 
@@ -188,10 +299,11 @@ void WtAddEdgeToTrees(Vertex tail, Vertex head, double weight, WtNetwork *nwp){
 #ifdef DEBUG
   if(WtEdgetreeSearch(tail, head, nwp->outedges)||WtEdgetreeSearch(head, tail, nwp->inedges)) error("WtAddEdgeToTrees() called for an extant edge. Note that this produces an error only if compiling with DEBUG macro set and silently produces undefined behavior otherwise.");
 #endif // DEBUG
+  if(!WtWeightFits(nwp->wttype, weight)) error("Edge value %f cannot be stored in the network's weight representation.", weight);
   for(unsigned int i = 0; i < nwp->n_on_edge_change; i++) nwp->on_edge_change[i](tail, head, weight, nwp->on_edge_change_payload[i], nwp, 0);
 
-  WtAddHalfedgeToTree(tail, head, weight, nwp->outedges, &(nwp->last_outedge));
-  WtAddHalfedgeToTree(head, tail, weight, nwp->inedges, &(nwp->last_inedge));
+  WtAddHalfedgeToTree(tail, head, weight, nwp->outedges, nwp->outweights, nwp->wttype, &(nwp->last_outedge));
+  WtAddHalfedgeToTree(head, tail, weight, nwp->inedges, nwp->inweights, nwp->wttype, &(nwp->last_inedge));
   ++nwp->outdegree[tail];
   ++nwp->indegree[head];
   ++EDGECOUNT(nwp);
@@ -216,11 +328,11 @@ int WtDeleteEdgeFromTrees(Vertex tail, Vertex head, WtNetwork *nwp){
   Edge zth, zht;
   if((zth=WtEdgetreeSearch(tail, head, nwp->outedges))&&(zht=WtEdgetreeSearch(head, tail, nwp->inedges))){
     if(nwp->n_on_edge_change){
-      double w = nwp->outedges[zth].weight;
+      double w = WtWeightGet(nwp->outweights, nwp->wttype, zth);
       for(unsigned int i = 0; i < nwp->n_on_edge_change; i++) nwp->on_edge_change[i](tail, head, 0, nwp->on_edge_change_payload[i], nwp, w);
     }
-    WtDeleteHalfedgeFromTreeAt(tail, head, nwp->outedges,&(nwp->last_outedge), zth);
-    WtDeleteHalfedgeFromTreeAt(head, tail, nwp->inedges, &(nwp->last_inedge), zht);
+    WtDeleteHalfedgeFromTreeAt(tail, head, nwp->outedges, nwp->outweights, nwp->wttype, &(nwp->last_outedge), zth);
+    WtDeleteHalfedgeFromTreeAt(head, tail, nwp->inedges, nwp->inweights, nwp->wttype, &(nwp->last_inedge), zht);
     --nwp->outdegree[tail];
     --nwp->indegree[head];
     --EDGECOUNT(nwp);
@@ -285,7 +397,6 @@ void Wtprintedge(Edge e, WtTreeNode *edges){
   Rprintf("\t.parent=%d\n",edges[e].parent);
   Rprintf("\t.left=%d\n",edges[e].left);
   Rprintf("\t.right=%d\n",edges[e].right);
-  Rprintf("\t.weight=%d\n",edges[e].weight);
 }
 
 /*****************
@@ -297,7 +408,8 @@ void WtNetworkEdgeList(WtNetwork *nwp) {
   Vertex i;
   for(i=1; i<=nwp->nnodes; i++) {
     Rprintf("Node %d:\n  ", i);
-    WtInOrderTreeWalk(nwp->outedges, i);
+    for(Edge e = WtEdgetreeMinimum(nwp->outedges, i); nwp->outedges[e].value != 0; e = WtEdgetreeSuccessor(nwp->outedges, e))
+      Rprintf(" %d:%f ", nwp->outedges[e].value, WtWeightGet(nwp->outweights, nwp->wttype, e));
     Rprintf("\n");
   }
 }
@@ -312,7 +424,7 @@ void WtInOrderTreeWalk(WtTreeNode *edges, Edge x) {
   if (x != 0) {
     WtInOrderTreeWalk(edges, (edges+x)->left);
     /*    printedge(x, edges); */
-    Rprintf(" %d:%f ",(edges+x)->value, (edges+x)->weight); 
+    Rprintf(" %d ",(edges+x)->value); 
     WtInOrderTreeWalk(edges, (edges+x)->right);
   }
 }
@@ -371,7 +483,7 @@ int WtFindithEdge (Vertex *tail, Vertex *head, double *weight, Edge i, WtNetwork
   }
   if(tail) *tail = taili;
   if(head) *head = nwp->outedges[e].value;
-  if(weight) *weight = nwp->outedges[e].weight;
+  if(weight) *weight = WtWeightGet(nwp->outweights, nwp->wttype, e);
   return 1;
 }
 
@@ -380,11 +492,18 @@ int WtFindithEdge (Vertex *tail, Vertex *head, double *weight, Edge i, WtNetwork
 
   Select an edge in the Network *nwp at random and update the values
   of tail and head appropriately. Return 1 if successful, 0 otherwise.
+
+  WtGetRandEdgeRNG() draws the uniforms from rng (see ergm_rng.h)
+  rather than from R's generator.
 ******************/
 
 /* *** don't forget tail->head, so this function now accepts tail before head */
 
 int WtGetRandEdge(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp) {
+  return WtGetRandEdgeRNG(tail, head, weight, nwp, NULL);
+}
+
+int WtGetRandEdgeRNG(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp, ErgmRNG *rng) {
   if(EDGECOUNT(nwp)==0) return(0);
   // FIXME: The constant maxEattempts needs to be tuned.
   const unsigned int maxEattempts=10;
@@ -393,7 +512,7 @@ int WtGetRandEdge(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp) {
   
   if(Eattempts>maxEattempts){
     // If the outedges is too sparse, revert to the old algorithm.
-    rane=1 + unif_rand() * EDGECOUNT(nwp);
+    rane=1 + ErgmRNGUnif(rng) * EDGECOUNT(nwp);
     WtFindithEdge(tail, head, weight, rane, nwp);
   }else{
     // Otherwise, find a TreeNode which has a head.
@@ -402,12 +521,12 @@ int WtGetRandEdge(Vertex *tail, Vertex *head, double *weight, WtNetwork *nwp) {
       // 0th one is always blank, and those with index >
       // nwp->last_outedge are blank as well, so we need to generate
       // an index from 1 through nwp->last_outedge (inclusive).
-      rane = 1 + unif_rand() * nwp->last_outedge;
+      rane = 1 + ErgmRNGUnif(rng) * nwp->last_outedge;
     }while((*head=nwp->outedges[rane].value)==0); // Form the head, while we are at it.
 
     // Get the weight.
     if(weight)
-      *weight=nwp->outedges[rane].weight;
+      *weight=WtWeightGet(nwp->outweights, nwp->wttype, rane);
     
     // Ascend the edgetree as long as we can.
     // Note that it will stop as soon as rane no longer has a parent,
@@ -546,7 +665,7 @@ Edge WtEdgeTree2EdgeList(Vertex *tails, Vertex *heads, double *weights, WtNetwor
 	e = WtEdgetreeSuccessor(nwp->outedges, e)){
       tails[nextedge] = v;
       heads[nextedge] = nwp->outedges[e].value;
-      if(weights) weights[nextedge] = nwp->outedges[e].weight;
+      if(weights) weights[nextedge] = WtWeightGet(nwp->outweights, nwp->wttype, e);
       nextedge++;
     }
   }
@@ -642,15 +761,17 @@ void WtSetEdge (Vertex tail, Vertex head, double weight, WtNetwork *nwp)
   }else{
     // Find the out-edge
     Edge oe=WtEdgetreeSearch(tail,head,nwp->outedges);
-    double w = nwp->outedges[oe].weight;
+    double w = WtWeightGet(nwp->outweights, nwp->wttype, oe);
     if(oe){
       // If it exists AND already has the target weight, do nothing.
       if(w==weight) return;
       else{
+        if(!WtWeightFits(nwp->wttype, weight)) error("Edge value %f cannot be stored in the network's weight representation.", weight);
         for(unsigned int i = 0; i < nwp->n_on_edge_change; i++) nwp->on_edge_change[i](tail, head, weight, nwp->on_edge_change_payload[i], nwp, w);
 	// Find the corresponding in-edge.
 	Edge ie=WtEdgetreeSearch(head,tail,nwp->inedges);
-	nwp->inedges[ie].weight=nwp->outedges[oe].weight=weight;
+	WtWeightPut(nwp->inweights, nwp->wttype, ie, weight);
+	WtWeightPut(nwp->outweights, nwp->wttype, oe, weight);
       }
     }else{
       // Otherwise, create a new edge with that weight.
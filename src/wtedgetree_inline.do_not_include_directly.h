@@ -8,7 +8,7 @@
  *  Copyright 2003-2022 Statnet Commons
  */
 
-static inline void WtRelocateHalfedge(Edge from, Edge to, WtTreeNode *edges){
+static inline void WtRelocateHalfedge(Edge from, Edge to, WtTreeNode *edges, void *weights, WtWeightType wttype){
   if(from==to) return;
   WtTreeNode *toptr=edges+to, *fromptr=edges+from;
 
@@ -20,6 +20,7 @@ static inline void WtRelocateHalfedge(Edge from, Edge to, WtTreeNode *edges){
     else parentptr->right =  to;
   }
   memcpy(toptr,fromptr,sizeof(WtTreeNode));
+  WtWeightPut(weights, wttype, to, WtWeightGet(weights, wttype, from));
   fromptr->value = 0;
 }
 
@@ -31,6 +32,7 @@ static inline void WtRelocateHalfedge(Edge from, Edge to, WtTreeNode *edges){
  value of *last_edge appropriately.
 *****************/
 static inline void WtDeleteHalfedgeFromTreeAt(Vertex a, Vertex b, WtTreeNode *edges,
+                                              void *weights, WtWeightType wttype,
                                               Edge *last_edge, Edge z){ 
   Edge x, root=(Edge)a;
   WtTreeNode *xptr, *zptr, *ptr;
@@ -47,7 +49,7 @@ static inline void WtDeleteHalfedgeFromTreeAt(Vertex a, Vertex b, WtTreeNode *ed
     else
       z=WtEdgetreePredecessor(edges, z);  
     zptr->value = (ptr=edges+z)->value;
-    zptr->weight = ptr->weight;
+    WtWeightPut(weights, wttype, zptr-edges, WtWeightGet(weights, wttype, z));
     zptr=ptr;
   }
   /* Set x to the child of z (there is at most one). */
@@ -56,7 +58,7 @@ static inline void WtDeleteHalfedgeFromTreeAt(Vertex a, Vertex b, WtTreeNode *ed
   /* Splice out node z */
   if (z == root) {
     zptr->value = (xptr=edges+x)->value;
-    zptr->weight = xptr->weight;
+    WtWeightPut(weights, wttype, z, WtWeightGet(weights, wttype, x));
     if (x != 0) {
       if ((zptr->left=xptr->left) != 0)
 	(edges+zptr->left)->parent = z;
@@ -76,7 +78,7 @@ static inline void WtDeleteHalfedgeFromTreeAt(Vertex a, Vertex b, WtTreeNode *ed
   /* Clear z node, update *last_edge if necessary. */
   zptr->value=0;
   if(z!=root){
-    WtRelocateHalfedge(*last_edge,z,edges);
+    WtRelocateHalfedge(*last_edge,z,edges,weights,wttype);
     (*last_edge)--;
   }
   return;
@@ -98,6 +100,11 @@ static inline void WtCheckEdgetreeFull (WtNetwork *nwp) {
     nwp->outedges = (WtTreeNode *) Realloc(nwp->outedges, newmax, WtTreeNode);
     memset(nwp->outedges+nwp->maxedges, 0,
 	   sizeof(WtTreeNode) * (newmax-nwp->maxedges));
+    size_t wtsize = WtWeightSize(nwp->wttype);
+    nwp->inweights = Realloc(nwp->inweights, newmax*wtsize, char);
+    memset((char *) nwp->inweights + nwp->maxedges*wtsize, 0, wtsize * (newmax-nwp->maxedges));
+    nwp->outweights = Realloc(nwp->outweights, newmax*wtsize, char);
+    memset((char *) nwp->outweights + nwp->maxedges*wtsize, 0, wtsize * (newmax-nwp->maxedges));
     nwp->maxedges = newmax;
   }
 }
@@ -105,18 +112,19 @@ static inline void WtCheckEdgetreeFull (WtNetwork *nwp) {
 /*****************
  void WtAddHalfedgeToTree:  Only called by WtAddEdgeToTrees
 *****************/
-static inline void WtAddHalfedgeToTree (Vertex a, Vertex b, double weight, WtTreeNode *edges, Edge *last_edge){
+static inline void WtAddHalfedgeToTree (Vertex a, Vertex b, double weight, WtTreeNode *edges,
+                                        void *weights, WtWeightType wttype, Edge *last_edge){
   WtTreeNode *eptr = edges+a, *newnode;
   Edge e;
 
   if (eptr->value==0) { /* This is the first edge for vertex a. */
     eptr->value=b;
-    eptr->weight = weight;  /*  Add weight too */
+    WtWeightPut(weights, wttype, a, weight);  /*  Add weight too */
     return;
   }
   (newnode = edges + (++*last_edge))->value=b;  
   newnode->left = newnode->right = 0;
-  newnode->weight=weight;  /*  Add weight too */
+  WtWeightPut(weights, wttype, *last_edge, weight);  /*  Add weight too */
   /* Now find the parent of this new edge */
   for (e=a; e!=0; e=(b < (eptr=edges+e)->value) ? eptr->left : eptr->right);
   newnode->parent=eptr-edges;  /* Point from the new edge to the parent... */
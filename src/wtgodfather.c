@@ -96,3 +96,98 @@ SEXP WtGodfather_wrapper(SEXP stateR,
   UNPROTECT(3);
   return outl;
 }
+
+/*****************
+ SEXP WtGodfatherStream_wrapper
+
+ A streaming version of WtGodfather_wrapper() that keeps the state
+ from one chunk of changes to the next, so that its memory use does
+ not grow with the length of the sequence. It repeatedly calls the R
+ function nextR in rho, which returns either NULL, to stop, or a
+ list of the tails, heads, and weights of the changes of one or more
+ time steps, separated by 0-sentinels as for WtGodfather_wrapper(); it
+ then calls the R function emitR in rho with the statistics after
+ each of these time steps, a vector in row-major order. It returns
+ the final statistics in place of the full matrix.
+
+ Since either R function may signal an error, the work is done by
+ WtGodfatherStream() under R_ExecWithCleanup(), so that the state is
+ freed and R's generator is put back however it exits.
+*****************/
+typedef struct {
+  WtErgmState *s;
+  SEXP nextR, emitR, rho, end_network, verbose;
+} WtGodfatherStreamArgs;
+
+static SEXP WtGodfatherStream(void *data){
+  WtGodfatherStreamArgs *a = data;
+  WtErgmState *s = a->s;
+  WtModel *m = s->m;
+
+  SEXP cur = PROTECT(allocVector(REALSXP, m->n_stats));
+  memcpy(REAL(cur), s->stats, m->n_stats*sizeof(double));
+
+  SEXP nextcall = PROTECT(lang1(a->nextR));
+  MCMCStatus status = MCMC_OK;
+  while(status == MCMC_OK){
+    SEXP chunk = PROTECT(eval(nextcall, a->rho));
+    if(isNull(chunk)){
+      UNPROTECT(1); // chunk
+      break;
+    }
+
+    SEXP changetails = VECTOR_ELT(chunk, 0);
+    unsigned int nstatrows = 1;
+    for(int *ct = INTEGER(changetails), *cte = ct+length(changetails); ct < cte ; ct++) if(*ct==0) nstatrows++;
+
+    SEXP stats = PROTECT(allocVector(REALSXP, m->n_stats*nstatrows));
+    memcpy(REAL(stats), REAL(cur), m->n_stats*sizeof(double));
+
+    status = WtGodfather(s, length(changetails), (Vertex*)INTEGER(changetails), (Vertex*)INTEGER(VECTOR_ELT(chunk, 1)), REAL(VECTOR_ELT(chunk, 2)), REAL(stats));
+    memcpy(REAL(cur), REAL(stats) + (nstatrows-1)*m->n_stats, m->n_stats*sizeof(double));
+
+    if(asInteger(a->verbose)) Rprintf("Applied %d changes in %u time steps.\n", length(changetails) - (nstatrows-1), nstatrows);
+
+    eval(PROTECT(lang2(a->emitR, stats)), a->rho);
+    UNPROTECT(3); // chunk, stats, emit call
+  }
+
+  const char *outn[] = {"status", "s", "state", ""};
+  SEXP outl = PROTECT(mkNamed(VECSXP, outn));
+  SET_VECTOR_ELT(outl, 0, ScalarInteger(status));
+  SET_VECTOR_ELT(outl, 1, cur);
+
+  /* record new generated network to pass back to R */
+  if(status == MCMC_OK && asInteger(a->end_network)){
+    s->stats = REAL(cur);
+    SET_VECTOR_ELT(outl, 2, WtErgmStateRSave(s));
+  }
+
+  /* Clean up here rather than in WtGodfatherStreamCleanup(), since
+     outl is not protected once this function returns. */
+  WtErgmStateDestroy(s);
+  a->s = NULL;
+  PutRNGstate();  /* Disable RNG before returning */
+  UNPROTECT(3);
+  return outl;
+}
+
+/* Only has anything left to do if WtGodfatherStream() exited early. */
+static void WtGodfatherStreamCleanup(void *data){
+  WtGodfatherStreamArgs *a = data;
+  if(a->s){
+    WtErgmStateDestroy(a->s);
+    a->s = NULL;
+    PutRNGstate();
+  }
+}
+
+SEXP WtGodfatherStream_wrapper(SEXP stateR,
+                               // Godfather settings
+                               SEXP nextR, SEXP emitR, SEXP rho,
+                               SEXP end_network,
+                               SEXP verbose){
+  GetRNGstate();  /* R function enabling uniform RNG */
+  WtGodfatherStreamArgs a = {WtErgmStateInit(stateR, ERGM_STATE_NO_INIT_PROP), nextR, emitR, rho, end_network, verbose};
+  return R_ExecWithCleanup(WtGodfatherStream, &a, WtGodfatherStreamCleanup, &a);
+}